@@ -1,20 +1,26 @@
 #include "testApp.h"
 
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
 
 //--------------------------------------------------------------
 void testApp::setup(){
 	ofSetVerticalSync(true);
 	ofSetFrameRate(120);
 	
-	for(int i=0; i<8; i++) {
-		ofxClutterRect* rect = new ofxClutterRect();
-		rect->setPosition(128, 128);
-		rect->setAnchor(128, 64);
-		rect->setSize(256, 128);
-		rect->setColor(ofRandom(0,255), ofRandom(0,255), ofRandom(0, 255), ofRandom(0, 255));
-		rect->setBorder(ofRandom(0,255), ofRandom(0,255), ofRandom(0, 255), ofRandom(0, 255), 2);
-		rects.push_back( rect );
+	// The spinning rectangles are described afresh every frame in update()
+	// and spinners works out which actors to touch
+	numSpinners = 8;
+	for(int i=0; i<32; i++) {
+		ClutterColor fill = { ofRandom(0,255), ofRandom(0,255), ofRandom(0,255), ofRandom(0,255) };
+		ClutterColor border = { ofRandom(0,255), ofRandom(0,255), ofRandom(0,255), ofRandom(0,255) };
+		spinnerColors.push_back(fill);
+		spinnerBorders.push_back(border);
 	}
+	spinners.render(ofxClutterNode::group("spinners"));	// under everything made after it
 	
 	rotation=0;
 
@@ -27,36 +33,33 @@ void testApp::setup(){
 	
 	//http://docs.clutter-project.org/docs/clutter-cookbook/1.0/
 	
-	ClutterKnot knot[4];
-	knot[0].x = 10;
-	knot[0].y = 10;
-	knot[1].x= ofGetWidth()-koala.getWidth();
-	knot[1].y= 0;
-	knot[2].x= ofGetWidth()-koala.getWidth();
-	knot[2].y= ofGetHeight()-koala.getHeight();
-	knot[3].x= 0;
-	knot[4].y= ofGetHeight()-koala.getHeight();
-	
-
+	// The koala goes round the edge of the window at a constant speed
+	float right = ofGetWidth() - koala.getWidth();
+	float bottom = ofGetHeight() - koala.getHeight();
+	koalaPath.moveTo(10, 10);
+	koalaPath.lineTo(right, 0);
+	koalaPath.lineTo(right, bottom);
+	koalaPath.lineTo(0, bottom);
+	koalaPath.close();
+	koalaPath.addFollower(&koala);
+	koalaPath.start(8000);
 	
-	transitions = clutter_state_new ();
+	// Saving the file while the app runs updates the overlay in place
+	overlay.load("overlay.json");
+	overlay.watch();
 	
 	/* start state, where bottom is opaque and top is transparent */
-	clutter_state_set (transitions, NULL, "show-bottom",
-					   koala.actor, "opacity", CLUTTER_LINEAR, 0,
-					   monalisaurus.actor, "opacity", CLUTTER_LINEAR, 255,
-					   NULL);
+	transitions.set("show-bottom", &koala, OFX_CLUTTER_TWEEN_OPACITY, 0);
+	transitions.set("show-bottom", &monalisaurus, OFX_CLUTTER_TWEEN_OPACITY, 255);
 	
 	/* end state, where top is opaque and bottom is transparent */
-	clutter_state_set (transitions, NULL, "show-top",
-					   koala.actor, "opacity", CLUTTER_EASE_IN_CUBIC, 255,
-					   monalisaurus.actor, "opacity", CLUTTER_EASE_IN_CUBIC, 0,
-					   NULL);
+	transitions.set("show-top", &koala, OFX_CLUTTER_TWEEN_OPACITY, 255, CLUTTER_EASE_IN_CUBIC);
+	transitions.set("show-top", &monalisaurus, OFX_CLUTTER_TWEEN_OPACITY, 0, CLUTTER_EASE_IN_CUBIC);
 	
 	/* set 1000ms duration for all transitions between states */
-	clutter_state_set_duration (transitions, NULL, NULL, 1000);
+	transitions.setDuration(1000);
 	
-	clutter_state_warp_to_state (transitions, "show-bottom");
+	transitions.warpToState("show-bottom");
 	top = false;
 	
 	//ofimg.loadImage("koala.jpg");
@@ -67,9 +70,16 @@ void testApp::update(){
 
 	rotation += 0.3;
 	
-	for(int i=0; i<rects.size(); i++) {
-		rects[i]->setZRotation( (i+1) * rotation );
+	ofxClutterNode group = ofxClutterNode::group("spinners");
+	for(int i=0; i<numSpinners; i++) {
+		ClutterColor b = spinnerBorders[i];
+		group.add(ofxClutterNode::rect(ofToString(i))
+				  .position(128, 128).anchor(128, 64).size(256, 128)
+				  .set(OFX_CLUTTER_SCENE_COLOR, spinnerColors[i])
+				  .border(b.red, b.green, b.blue, b.alpha, 2)
+				  .rotation((i+1) * rotation));
 	}
+	spinners.render(group);
 }
 
 //--------------------------------------------------------------
@@ -99,6 +109,23 @@ void testApp::keyReleased(int key){
 		case 'f':
 			ofToggleFullscreen();
 			break;
+		case 'b':
+			runCacheBenchmark(2000);
+			break;
+		case 'u':
+			runBlurBenchmark(8, 100);
+			break;
+		case 'e':
+			runEasingBenchmark(1000000);
+			break;
+		case 'l':
+			runSceneBenchmark(5000);
+			break;
+		case '+':
+		case '-':
+			numSpinners = ofClamp(numSpinners + (key == '+' ? 1 : -1), 0, spinnerColors.size());
+			cout << numSpinners << " spinners, " << spinners.getNumPatches() << " patches last frame" << endl;
+			break;
 	}
 }
 
@@ -121,9 +148,9 @@ void testApp::mousePressed(int x, int y, int button){
 void testApp::mouseReleased(int x, int y, int button){
 	cout << "mousePressed: x=" << x << " y=" << y << endl;
 	if(top)
-		clutter_state_set_state(transitions, "show-bottom");
+		transitions.setState("show-bottom");
 	else
-		clutter_state_set_state(transitions, "show-top");
+		transitions.setState("show-top");
 	
 	top=!top;
 }
@@ -133,3 +160,230 @@ void testApp::windowResized(int w, int h){
 
 }
 
+//--------------------------------------------------------------
+static int loadAll(ofxClutterTexture& tex, vector<string>& paths) {
+	int start = ofGetElapsedTimeMillis();
+	for(int i=0; i<paths.size(); i++) {
+		tex.loadImage(paths[i]);
+	}
+	cogl_flush();
+	return ofGetElapsedTimeMillis() - start;
+}
+
+//--------------------------------------------------------------
+// Cold vs. warm startup with the decoded-image cache.  The data folder
+// only has two images, so they are copied until there are numImages
+// distinct files, then all of them are loaded three times: without the
+// cache, with an empty cache (decode + write) and with a full one (mmap).
+void testApp::runCacheBenchmark(int numImages) {
+	string dir = ofToDataPath("cacheBenchmark", true);
+	string cacheDir = dir + "/cache";
+	g_mkdir_with_parents(dir.c_str(), 0755);
+	
+	const char* sources[] = { "koala.jpg", "monalisaurus.jpg" };
+	vector<string> paths;
+	for(int i=0; i<numImages; i++) {
+		char name[32];
+		sprintf(name, "/image%05d.jpg", i);
+		string path = dir + name;
+		if(!g_file_test(path.c_str(), G_FILE_TEST_EXISTS)) {
+			gchar* contents;
+			gsize length;
+			if(g_file_get_contents(ofToDataPath(sources[i%2], true).c_str(), &contents, &length, NULL)) {
+				g_file_set_contents(path.c_str(), contents, length, NULL);
+				g_free(contents);
+			}
+		}
+		paths.push_back(path);
+	}
+	
+	// Start cold: throw away whatever the last run cached
+	GDir* cached = g_dir_open(cacheDir.c_str(), 0, NULL);
+	if(cached) {
+		const gchar* name;
+		while((name = g_dir_read_name(cached))) {
+			remove((cacheDir + "/" + name).c_str());
+		}
+		g_dir_close(cached);
+	}
+	
+	ofxClutterTexture tex;
+	clutter_actor_hide(tex.actor);
+	
+	string previousCacheDir = ofxClutterTexture::getCacheDirectory();
+	ofxClutterTexture::setCacheDirectory("");
+	int uncachedMillis = loadAll(tex, paths);
+	ofxClutterTexture::setCacheDirectory(cacheDir);
+	int coldMillis = loadAll(tex, paths);
+	int warmMillis = loadAll(tex, paths);
+	ofxClutterTexture::setCacheDirectory(previousCacheDir);
+	
+	clutter_actor_destroy(tex.actor);
+	
+	cout << "texture cache benchmark, " << numImages << " images" << endl;
+	cout << "  no cache:   " << uncachedMillis << " ms" << endl;
+	cout << "  cold cache: " << coldMillis << " ms" << endl;
+	cout << "  warm cache: " << warmMillis << " ms" << endl;
+}
+
+
+//--------------------------------------------------------------
+// Paints the stage numFrames times and waits for the GPU each time.  With
+// invalidate set, the blur effects throw away their cache before each frame.
+static float timeFrames(int numFrames, vector<ofxClutterBlurEffect*>* invalidate) {
+	int start = ofGetElapsedTimeMillis();
+	for(int i=0; i<numFrames; i++) {
+		if(invalidate) {
+			for(int j=0; j<invalidate->size(); j++) (*invalidate)[j]->invalidateSource();
+		}
+		clutter_redraw(CLUTTER_STAGE(stage));
+		glFinish();
+	}
+	return (ofGetElapsedTimeMillis() - start) / (float)numFrames;
+}
+
+//--------------------------------------------------------------
+// ClutterBlurEffect against ofxClutterBlurEffect on large panels, the
+// latter both re-blurring every frame and drawing from its cache.
+void testApp::runBlurBenchmark(int numPanels, int numFrames) {
+	vector<ofxClutterTexture*> panels;
+	for(int i=0; i<numPanels; i++) {
+		ofxClutterTexture* panel = new ofxClutterTexture();
+		panel->loadImage("koala.jpg");
+		panel->setSize(640, 480);
+		panel->setPosition(20 * i, 20 * i);
+		panels.push_back(panel);
+	}
+	float noBlurMillis = timeFrames(numFrames, NULL);
+	
+	for(int i=0; i<numPanels; i++) {
+		clutter_actor_add_effect_with_name(panels[i]->actor, "blur", clutter_blur_effect_new());
+	}
+	float clutterMillis = timeFrames(numFrames, NULL);
+	for(int i=0; i<numPanels; i++) {
+		clutter_actor_remove_effect_by_name(panels[i]->actor, "blur");
+	}
+	
+	vector<ofxClutterBlurEffect*> blurs;
+	for(int i=0; i<numPanels; i++) {
+		blurs.push_back(new ofxClutterBlurEffect(16));
+		blurs[i]->apply(panels[i]);
+	}
+	float uncachedMillis = timeFrames(numFrames, &blurs);
+	float cachedMillis = timeFrames(numFrames, NULL);
+	
+	for(int i=0; i<numPanels; i++) {
+		delete blurs[i];
+		clutter_actor_destroy(panels[i]->actor);
+		delete panels[i];
+	}
+	
+	cout << "blur benchmark, " << numPanels << " 640x480 panels, ms per frame" << endl;
+	cout << "  no blur:                  " << noBlurMillis << endl;
+	cout << "  ClutterBlurEffect:        " << clutterMillis << endl;
+	cout << "  ofxClutterBlurEffect(16): " << uncachedMillis << endl;
+	cout << "  ...cached:                " << cachedMillis << endl;
+}
+
+//--------------------------------------------------------------
+// Batched easing (SIMD where the build allows it) against the scalar
+// curves and against one ClutterAlpha evaluation per value.
+void testApp::runEasingBenchmark(int numValues) {
+	const int modes[] = { CLUTTER_LINEAR, CLUTTER_EASE_IN_CUBIC, CLUTTER_EASE_IN_OUT_QUINT,
+		CLUTTER_EASE_OUT_BOUNCE, CLUTTER_EASE_IN_OUT_SINE };
+	const char* names[] = { "linear", "ease-in-cubic", "ease-in-out-quint", "ease-out-bounce", "ease-in-out-sine" };
+	
+	vector<float> in(numValues), out(numValues);
+	for(int i=0; i<numValues; i++) in[i] = i / (float)(numValues - 1);
+	
+	// ClutterAlpha only takes whole milliseconds of a timeline, so give it
+	// a timeline as long as the number of values
+	ClutterTimeline* timeline = clutter_timeline_new(numValues);
+	GTimer* timer = g_timer_new();
+	
+	cout << "easing benchmark, " << numValues << " values, ns per value (" << ofxClutterEasing::getInstructionSet() << ")" << endl;
+	for(int m=0; m<5; m++) {
+		g_timer_start(timer);
+		ofxClutterEasing::evaluate(modes[m], &in[0], &out[0], numValues);
+		double batched = g_timer_elapsed(timer, NULL);
+		
+		g_timer_start(timer);
+		ofxClutterEasing::evaluateScalar(modes[m], &in[0], &out[0], numValues);
+		double scalar = g_timer_elapsed(timer, NULL);
+		
+		ClutterAlpha* alpha = clutter_alpha_new_full(timeline, modes[m]);
+		g_timer_start(timer);
+		for(int i=0; i<numValues; i++) {
+			clutter_timeline_advance(timeline, i);
+			clutter_alpha_get_alpha(alpha);
+		}
+		double clutter = g_timer_elapsed(timer, NULL);
+		g_object_unref(alpha);
+		
+		cout << "  " << names[m] << ": batched " << batched * 1e9 / numValues
+			 << ", scalar " << scalar * 1e9 / numValues
+			 << ", ClutterAlpha " << clutter * 1e9 / numValues << endl;
+	}
+	
+	g_timer_destroy(timer);
+	g_object_unref(timeline);
+}
+
+//--------------------------------------------------------------
+// Writes a ClutterScript file with numActors rectangles and labels in a
+// group, then loads it with ClutterScript and as a converted ofxClutterScene.
+void testApp::runSceneBenchmark(int numActors) {
+	string dir = ofToDataPath("sceneBenchmark", true);
+	g_mkdir_with_parents(dir.c_str(), 0755);
+	string jsonPath = dir + "/scene.json";
+	string scenePath = dir + "/scene.ofxscene";
+	
+	string json = "[ { \"id\": \"root\", \"type\": \"ClutterGroup\", \"children\": [\n";
+	for(int i=0; i<numActors; i++) {
+		char line[256];
+		if(i % 2 == 0) {
+			sprintf(line, "{ \"id\": \"item%d\", \"type\": \"ClutterRectangle\", \"x\": %d, \"y\": %d, "
+					"\"width\": 40, \"height\": 30, \"color\": \"#%02x%02x%02xff\", \"opacity\": 200 }",
+					i, (i * 7) % 1000, (i * 13) % 700, i % 256, (i * 3) % 256, (i * 5) % 256);
+		} else {
+			sprintf(line, "{ \"id\": \"item%d\", \"type\": \"ClutterText\", \"x\": %d, \"y\": %d, "
+					"\"text\": \"label %d\", \"font-name\": \"Sans 10\", \"color\": \"white\" }",
+					i, (i * 7) % 1000, (i * 13) % 700, i);
+		}
+		json += line;
+		json += (i < numActors - 1) ? ",\n" : "\n";
+	}
+	json += "] } ]\n";
+	g_file_set_contents(jsonPath.c_str(), json.c_str(), json.size(), NULL);
+	
+	GTimer* timer = g_timer_new();
+	ClutterScript* script = clutter_script_new();
+	GError* error = NULL;
+	if(!clutter_script_load_from_file(script, jsonPath.c_str(), &error)) {
+		cout << "ClutterScript couldn't load " << jsonPath << ": " << error->message << endl;
+		g_error_free(error);
+	}
+	ClutterActor* root = CLUTTER_ACTOR(clutter_script_get_object(script, "root"));
+	if(root) {
+		clutter_container_add_actor(CLUTTER_CONTAINER(stage), root);
+		clutter_actor_show_all(root);
+	}
+	double scriptMillis = g_timer_elapsed(timer, NULL) * 1000;
+	if(root) clutter_actor_destroy(root);
+	g_object_unref(script);
+	
+	g_timer_start(timer);
+	ofxClutterScene::convert(jsonPath, scenePath);
+	double convertMillis = g_timer_elapsed(timer, NULL) * 1000;
+	g_timer_destroy(timer);
+	
+	ofxClutterScene scene;
+	scene.load(scenePath);
+	float sceneMillis = scene.getLoadMillis();
+	scene.clear();
+	
+	cout << "scene benchmark, " << numActors << " actors" << endl;
+	cout << "  ClutterScript:       " << scriptMillis << " ms" << endl;
+	cout << "  convert (once):      " << convertMillis << " ms" << endl;
+	cout << "  ofxClutterScene:     " << sceneMillis << " ms" << endl;
+}
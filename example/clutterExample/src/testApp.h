@@ -6,6 +6,13 @@
 #include "ofxClutterRect.h"
 #include "ofxClutterTexture.h"
 #include "ofxClutterText.h"
+#include "ofxClutterBlurEffect.h"
+#include "ofxClutterEasing.h"
+#include "ofxClutterState.h"
+#include "ofxClutterPath.h"
+#include "ofxClutterScene.h"
+#include "ofxClutterLiveScene.h"
+#include "ofxClutterReconciler.h"
 #include <clutter/clutter.h>
 
 class testApp : public ofBaseApp{
@@ -23,13 +30,22 @@ class testApp : public ofBaseApp{
 		void mouseReleased(int x, int y, int button);
 		void windowResized(int w, int h);
 	
+		void runCacheBenchmark(int numImages);
+		void runBlurBenchmark(int numPanels, int numFrames);
+		void runEasingBenchmark(int numValues);
+		void runSceneBenchmark(int numActors);
+	
 		ofImage ofimg;
 		float rotation;
-		vector<ofxClutterRect*> rects;
+		ofxClutterReconciler spinners;
+		vector<ClutterColor> spinnerColors, spinnerBorders;
+		int numSpinners;
 		ofxClutterTexture koala, monalisaurus;
+		ofxClutterPath koalaPath;
 		ofxClutterText text;
+		ofxClutterLiveScene overlay;
 	
-		ClutterState *transitions;
+		ofxClutterState transitions;
 		bool top;
 };
 
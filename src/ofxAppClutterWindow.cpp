@@ -10,6 +10,7 @@
 #include "ofxAppClutterWindow.h"
 #include "ofBaseApp.h"
 #include "ofMain.h"
+#include "ofxClutterColor.h"
 
 // Some of the callback methods (and other classes) 
 // need to know about the stage and the app pointer
@@ -29,6 +30,10 @@ ofxAppClutterWindow::ofxAppClutterWindow(int argc, char *argv[]){
 	//char *argv = (char*)"openframeworks";
 	//char **vptr = &argv;
 	
+	// Worker pools (ofxClutterWorkerPool) need GLib threads, and
+	// g_thread_init has to happen before clutter_init starts using GLib.
+	if(!g_thread_supported()) g_thread_init(NULL);
+	
 	clutter_init(&argc, &argv);
 }
 
@@ -206,6 +211,24 @@ void ofxAppClutterWindow::setWindowTitle(string title){
 }
 
 
+//------------------------------------------------------------
+void ofxAppClutterWindow::setBackgroundColor(int r, int g, int b, int a) {
+	ClutterColor col = {r, g, b, a};
+	clutter_stage_set_color(CLUTTER_STAGE(stage), &col);
+}
+
+
+//------------------------------------------------------------
+void ofxAppClutterWindow::setBackgroundColor(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_ERROR, "ofxAppClutterWindow: unknown color " + color);
+		return;
+	}
+	clutter_stage_set_color(CLUTTER_STAGE(stage), &col);
+}
+
+
 //------------------------------------------------------------
 void ofxAppClutterWindow::hideCursor() {
 	clutter_stage_show_cursor(CLUTTER_STAGE(stage));
@@ -45,6 +45,10 @@ class ofxAppClutterWindow : public ofAppBaseWindow {
 	void	setFrameRate(float targetRate);
 	void	setWindowTitle(string title);
 	
+	// Stage color; the string takes a CSS/X11 name or #rrggbb[aa]
+	void	setBackgroundColor(int r, int g, int b, int a=255);
+	void	setBackgroundColor(const string& color);
+	
 	int		getWindowMode();
 	
 	void	setFullscreen(bool fullscreen);
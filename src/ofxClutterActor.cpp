@@ -8,6 +8,7 @@
  */
 
 #include "ofxClutterActor.h"
+#include "ofxClutterCachedEffect.h"
 
 // We need access to the stage
 extern "C" {
@@ -60,3 +61,36 @@ void ofxClutterActor::setSize(int w, int h) {
 void ofxClutterActor::setZRotation(float angle) {
 	clutter_actor_set_rotation(actor, CLUTTER_Z_AXIS, angle, 0, 0, 0);
 }
+
+
+//------------------------------------------------------------
+ofxClutterActor::~ofxClutterActor() {
+	delete bitmapCache;
+}
+
+
+//------------------------------------------------------------
+// A plain ofxClutterCachedEffect: process() draws the source as it is
+void ofxClutterActor::setCacheAsBitmap(bool cache) {
+	if(cache == getCacheAsBitmap()) return;
+	if(cache) {
+		bitmapCache = new ofxClutterCachedEffect();
+		bitmapCache->apply(this);
+	}
+	else {
+		delete bitmapCache;
+		bitmapCache = NULL;
+	}
+}
+
+
+//------------------------------------------------------------
+int ofxClutterActor::getNumCacheHits() {
+	return bitmapCache ? bitmapCache->getNumCacheHits() : 0;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterActor::getNumCacheRenders() {
+	return bitmapCache ? bitmapCache->getNumRenders() : 0;
+}
@@ -11,8 +11,12 @@
 #include "ofMain.h"
 #include <clutter/clutter.h>
 
+class ofxClutterCachedEffect;
+
 class ofxClutterActor {
 public:
+	ofxClutterActor() : bitmapCache(NULL) {}
+	~ofxClutterActor();
 	
 	void setPosition(int x, int y);
 	void setAnchor(int x, int y);
@@ -22,6 +26,21 @@ public:
 	void setSize(int w, int h);
 	void setZRotation(float angle);
 	
+	// Keeps a bitmap of the actor and its children and draws that instead
+	// of painting them, until one of them queues a redraw or the paint
+	// opacity (a parent fading) changes.  Worth it for complicated groups
+	// that rarely change.
+	void setCacheAsBitmap(bool cache);
+	bool getCacheAsBitmap() { return bitmapCache != NULL; }
+	int getNumCacheHits();		// paints served from the bitmap
+	int getNumCacheRenders();	// paints that re-rendered it
+	
 //protected:
 	ClutterActor *actor;
+	ofxClutterCachedEffect* bitmapCache;
+	
+private:
+	// Not copyable: a copy would share, and later delete, the bitmap cache
+	ofxClutterActor(const ofxClutterActor&);
+	ofxClutterActor& operator=(const ofxClutterActor&);
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+/*
+ *  ofxClutterBlurEffect.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterBlurEffect.h"
+
+static const int maxIterations = 6;
+
+// halfpixel is half a source texel, scaled by the sample offset
+static const char* downShader =
+	"uniform sampler2D tex;\n"
+	"uniform vec2 halfpixel;\n"
+	"void main() {\n"
+	"  vec2 st = gl_TexCoord[0].st;\n"
+	"  vec4 sum = texture2D(tex, st) * 4.0;\n"
+	"  sum += texture2D(tex, st - halfpixel);\n"
+	"  sum += texture2D(tex, st + halfpixel);\n"
+	"  sum += texture2D(tex, st + vec2(halfpixel.x, -halfpixel.y));\n"
+	"  sum += texture2D(tex, st - vec2(halfpixel.x, -halfpixel.y));\n"
+	"  gl_FragColor = sum / 8.0;\n"
+	"}\n";
+
+static const char* upShader =
+	"uniform sampler2D tex;\n"
+	"uniform vec2 halfpixel;\n"
+	"void main() {\n"
+	"  vec2 st = gl_TexCoord[0].st;\n"
+	"  vec4 sum = texture2D(tex, st + vec2(-halfpixel.x * 2.0, 0.0));\n"
+	"  sum += texture2D(tex, st + vec2(-halfpixel.x, halfpixel.y)) * 2.0;\n"
+	"  sum += texture2D(tex, st + vec2(0.0, halfpixel.y * 2.0));\n"
+	"  sum += texture2D(tex, st + vec2(halfpixel.x, halfpixel.y)) * 2.0;\n"
+	"  sum += texture2D(tex, st + vec2(halfpixel.x * 2.0, 0.0));\n"
+	"  sum += texture2D(tex, st + vec2(halfpixel.x, -halfpixel.y)) * 2.0;\n"
+	"  sum += texture2D(tex, st + vec2(0.0, -halfpixel.y * 2.0));\n"
+	"  sum += texture2D(tex, st + vec2(-halfpixel.x, -halfpixel.y)) * 2.0;\n"
+	"  gl_FragColor = sum / 12.0;\n"
+	"}\n";
+
+
+//------------------------------------------------------------
+static CoglHandle getProgram(const char* source) {
+	CoglHandle shader = cogl_create_shader(COGL_SHADER_TYPE_FRAGMENT);
+	cogl_shader_source(shader, source);
+	cogl_shader_compile(shader);
+	if(!cogl_shader_is_compiled(shader)) {
+		char* log = cogl_shader_get_info_log(shader);
+		ofLog(OF_LOG_ERROR, "ofxClutterBlurEffect: shader didn't compile.");
+		fprintf (stderr, "%s\n", log);
+		g_free(log);
+		cogl_handle_unref(shader);
+		return COGL_INVALID_HANDLE;
+	}
+	
+	CoglHandle program = cogl_create_program();
+	cogl_program_attach_shader(program, shader);
+	cogl_program_link(program);
+	cogl_handle_unref(shader);
+	
+	int location = cogl_program_get_uniform_location(program, "tex");
+	if(location >= 0) cogl_program_set_uniform_1i(program, location, 0);
+	return program;
+}
+
+
+//------------------------------------------------------------
+ofxClutterBlurEffect::ofxClutterBlurEffect(float radius) {
+	passMaterial = cogl_material_new();
+	this->radius = -1;
+	setRadius(radius);
+}
+
+
+//------------------------------------------------------------
+ofxClutterBlurEffect::~ofxClutterBlurEffect() {
+	// Release the targets before the material they may be attached to
+	remove();
+	cogl_handle_unref(passMaterial);
+}
+
+
+//------------------------------------------------------------
+// Each down/up iteration pair roughly doubles the reach of the kernel, so
+// pick the iterations that get close and make up the rest with the offset.
+void ofxClutterBlurEffect::setRadius(float radius) {
+	if(radius == this->radius) return;
+	this->radius = radius;
+	
+	iterations = 1;
+	while(iterations < maxIterations && (2 << iterations) * 1.5f < radius) iterations++;
+	offset = MAX(1.0f, radius / ((2 << iterations) * 0.75f));
+	invalidate();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterBlurEffect::runPass(CoglHandle program, int halfPixelLocation, CoglHandle src, CoglHandle dest) {
+	float halfPixel[2] = {
+		0.5f * offset / cogl_texture_get_width(src),
+		0.5f * offset / cogl_texture_get_height(src)
+	};
+	cogl_program_set_uniform_float(program, halfPixelLocation, 2, 1, halfPixel);
+	cogl_material_set_layer(passMaterial, 0, src);
+	cogl_material_set_user_program(passMaterial, program);
+	drawInto(dest, passMaterial);
+}
+
+
+//------------------------------------------------------------
+// Down to 1/2^iterations, then back up to half size; the result is drawn
+// stretched over the actor, where bilinear filtering hides the scale.
+CoglHandle ofxClutterBlurEffect::process(CoglHandle source, int w, int h) {
+	static CoglHandle down = getProgram(downShader);
+	static CoglHandle up = getProgram(upShader);
+	if(down == COGL_INVALID_HANDLE || up == COGL_INVALID_HANDLE || radius <= 0) return source;
+	static int downLocation = cogl_program_get_uniform_location(down, "halfpixel");
+	static int upLocation = cogl_program_get_uniform_location(up, "halfpixel");
+	
+	vector<CoglHandle> levels;
+	levels.push_back(source);
+	for(int i=1; i<=iterations; i++) {
+		CoglHandle level = ofxClutterOffscreenPool::acquire(MAX(1, w >> i), MAX(1, h >> i));
+		if(level == COGL_INVALID_HANDLE) break;
+		runPass(down, downLocation, levels.back(), level);
+		levels.push_back(level);
+	}
+	
+	CoglHandle current = levels.back();
+	for(int i=levels.size()-2; i>=1; i--) {
+		CoglHandle level = ofxClutterOffscreenPool::acquire(cogl_texture_get_width(levels[i]), cogl_texture_get_height(levels[i]));
+		if(level == COGL_INVALID_HANDLE) break;
+		runPass(up, upLocation, current, level);
+		if(current != levels.back()) ofxClutterOffscreenPool::releaseAfterFrame(current);
+		current = level;
+	}
+	
+	// Everything but the source and the result goes back to the pool
+	for(int i=1; i<levels.size(); i++) {
+		if(levels[i] != current) ofxClutterOffscreenPool::releaseAfterFrame(levels[i]);
+	}
+	return current;
+}
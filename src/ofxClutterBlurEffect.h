@@ -0,0 +1,35 @@
+/*
+ *  ofxClutterBlurEffect.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterCachedEffect.h"
+
+
+// Dual-Kawase blur for large actors such as frosted-glass panels.  The
+// actor is halved in size a few times with a 5-tap filter and scaled back
+// up with an 8-tap one, stopping at half resolution, so the cost barely
+// grows with the radius.  The blurred image is cached until the actor or
+// the radius changes.
+class ofxClutterBlurEffect : public ofxClutterCachedEffect {
+public:
+	ofxClutterBlurEffect(float radius=8);
+	~ofxClutterBlurEffect();
+	
+	// Approximate blur radius in pixels of the actor
+	void setRadius(float radius);
+	float getRadius() { return radius; }
+	
+	int getNumIterations() { return iterations; }
+	
+protected:
+	CoglHandle process(CoglHandle source, int w, int h);
+	void runPass(CoglHandle program, int halfPixelLocation, CoglHandle src, CoglHandle dest);
+	
+	float radius;
+	int iterations;
+	float offset;
+	CoglMaterial* passMaterial;
+};
@@ -0,0 +1,260 @@
+/*
+ *  ofxClutterCachedEffect.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterCachedEffect.h"
+
+
+// ClutterOffscreenEffect in Clutter 1.4 re-renders its actor on every
+// paint and keeps its state private, so this redirects painting itself.
+typedef struct {
+	ClutterEffect parent;
+	ofxClutterCachedEffect* owner;
+} OfxCachedEffect;
+
+typedef struct {
+	ClutterEffectClass parent_class;
+} OfxCachedEffectClass;
+
+G_DEFINE_TYPE(OfxCachedEffect, ofx_cached_effect, CLUTTER_TYPE_EFFECT);
+
+
+//------------------------------------------------------------
+static gboolean ofx_cached_effect_pre_paint(ClutterEffect* effect) {
+	return ((OfxCachedEffect*)effect)->owner->prePaint();
+}
+
+
+//------------------------------------------------------------
+static void ofx_cached_effect_post_paint(ClutterEffect* effect) {
+	((OfxCachedEffect*)effect)->owner->postPaint();
+}
+
+
+//------------------------------------------------------------
+static void ofx_cached_effect_class_init(OfxCachedEffectClass* klass) {
+	CLUTTER_EFFECT_CLASS(klass)->pre_paint = ofx_cached_effect_pre_paint;
+	CLUTTER_EFFECT_CLASS(klass)->post_paint = ofx_cached_effect_post_paint;
+}
+
+
+//------------------------------------------------------------
+static void ofx_cached_effect_init(OfxCachedEffect* self) {
+	self->owner = NULL;
+}
+
+
+//------------------------------------------------------------
+static void onTargetQueueRedraw(ClutterActor* actor, ClutterActor* origin, gpointer data) {
+	((ofxClutterCachedEffect*)data)->targetQueuedRedraw();
+}
+
+
+//------------------------------------------------------------
+// Connected before the class handler, which is what paints the actor and
+// its children, so stopping the emission here skips all of that
+static void onTargetPaint(ClutterActor* actor, gpointer data) {
+	if(((ofxClutterCachedEffect*)data)->isSkippingPaint()) g_signal_stop_emission_by_name(actor, "paint");
+}
+
+
+//------------------------------------------------------------
+static void onTargetDestroy(ClutterActor* actor, gpointer data) {
+	((ofxClutterCachedEffect*)data)->targetDestroyed();
+}
+
+
+//------------------------------------------------------------
+ofxClutterCachedEffect::ofxClutterCachedEffect() {
+	OfxCachedEffect* self = (OfxCachedEffect*)g_object_new(ofx_cached_effect_get_type(), NULL);
+	self->owner = this;
+	effect = CLUTTER_EFFECT(self);
+	g_object_ref_sink(effect);
+	
+	target = NULL;
+	redrawHandler = paintHandler = destroyHandler = 0;
+	queueingRedraw = false;
+	source = result = COGL_INVALID_HANDLE;
+	material = cogl_material_new();
+	width = height = 0;
+	sourceValid = resultValid = false;
+	skipping = false;
+	sourceOpacity = 255;
+	resetStats();
+}
+
+
+//------------------------------------------------------------
+ofxClutterCachedEffect::~ofxClutterCachedEffect() {
+	remove();
+	g_object_unref(effect);
+	cogl_handle_unref(material);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::apply(ofxClutterActor* target) {
+	remove();
+	this->target = target->actor;
+	clutter_actor_add_effect(this->target, effect);
+	
+	// Emitted for the actor and, through it, for all of its children
+	redrawHandler = g_signal_connect(this->target, "queue-redraw", G_CALLBACK(onTargetQueueRedraw), this);
+	paintHandler = g_signal_connect(this->target, "paint", G_CALLBACK(onTargetPaint), this);
+	destroyHandler = g_signal_connect(this->target, "destroy", G_CALLBACK(onTargetDestroy), this);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::remove() {
+	if(target == NULL) return;
+	g_signal_handler_disconnect(target, redrawHandler);
+	g_signal_handler_disconnect(target, paintHandler);
+	g_signal_handler_disconnect(target, destroyHandler);
+	clutter_actor_remove_effect(target, effect);
+	target = NULL;
+	releaseTargets();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::invalidate() {
+	if(!resultValid) return;
+	resultValid = false;
+	queueRedraw();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::invalidateSource() {
+	if(!sourceValid) return;
+	sourceValid = false;
+	queueRedraw();
+}
+
+
+//------------------------------------------------------------
+// Redraws we ask for ourselves don't mean the actor changed
+void ofxClutterCachedEffect::queueRedraw() {
+	if(target == NULL) return;
+	queueingRedraw = true;
+	clutter_actor_queue_redraw(target);
+	queueingRedraw = false;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::targetQueuedRedraw() {
+	if(!queueingRedraw) sourceValid = false;
+}
+
+
+//------------------------------------------------------------
+// The actor drops its effects when it's destroyed; just forget it
+void ofxClutterCachedEffect::targetDestroyed() {
+	target = NULL;
+	releaseTargets();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::releaseTargets() {
+	if(result != COGL_INVALID_HANDLE && result != source) ofxClutterOffscreenPool::releaseAfterFrame(result);
+	if(source != COGL_INVALID_HANDLE) ofxClutterOffscreenPool::releaseAfterFrame(source);
+	source = result = COGL_INVALID_HANDLE;
+	sourceValid = resultValid = false;
+}
+
+
+//------------------------------------------------------------
+// Either skips the actor's paint altogether (see onTargetPaint), because
+// the cached copy will be drawn instead, or sends it to the source target
+// with a projection that maps the actor's own coordinates onto it.
+bool ofxClutterCachedEffect::prePaint() {
+	skipping = false;
+	if(target == NULL) return false;
+	
+	gfloat w, h;
+	clutter_actor_get_size(target, &w, &h);
+	int iw = ceilf(w);
+	int ih = ceilf(h);
+	if(iw < 1 || ih < 1) return false;
+	
+	// The paint opacity, which includes the parents', is baked into the
+	// source, and a fading parent doesn't queue a redraw on its children
+	guint8 opacity = clutter_actor_get_paint_opacity(target);
+	if(sourceValid && iw == width && ih == height && opacity == sourceOpacity) {
+		skipping = true;
+		numCacheHits++;
+		return true;
+	}
+	
+	if(iw != width || ih != height) {
+		releaseTargets();
+		width = iw;
+		height = ih;
+	}
+	if(source == COGL_INVALID_HANDLE) {
+		source = ofxClutterOffscreenPool::acquire(width, height);
+		if(source == COGL_INVALID_HANDLE) return false;
+	}
+	
+	CoglColor transparent;
+	cogl_color_set_from_4ub(&transparent, 0, 0, 0, 0);
+	CoglMatrix identity;
+	cogl_matrix_init_identity(&identity);
+	
+	cogl_push_framebuffer((CoglFramebuffer*)ofxClutterOffscreenPool::getFramebuffer(source));
+	cogl_set_viewport(0, 0, width, height);
+	cogl_ortho(0, width, height, 0, -1, 1);
+	cogl_set_modelview_matrix(&identity);
+	cogl_clear(&transparent, COGL_BUFFER_BIT_COLOR);
+	sourceOpacity = opacity;
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::postPaint() {
+	if(!skipping) {
+		cogl_pop_framebuffer();
+		sourceValid = true;
+		resultValid = false;
+		numRenders++;
+	}
+	skipping = false;
+	
+	if(!resultValid) {
+		if(result != COGL_INVALID_HANDLE && result != source) ofxClutterOffscreenPool::releaseAfterFrame(result);
+		result = process(source, width, height);
+		resultValid = true;
+		numProcesses++;
+	}
+	
+	// The source already has the paint opacity in it
+	cogl_material_set_layer(material, 0, result);
+	cogl_set_source(material);
+	cogl_rectangle(0, 0, width, height);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCachedEffect::drawInto(CoglHandle dest, CoglMaterial* material) {
+	int w = cogl_texture_get_width(dest);
+	int h = cogl_texture_get_height(dest);
+	CoglColor transparent;
+	cogl_color_set_from_4ub(&transparent, 0, 0, 0, 0);
+	CoglMatrix identity;
+	cogl_matrix_init_identity(&identity);
+	
+	cogl_push_framebuffer((CoglFramebuffer*)ofxClutterOffscreenPool::getFramebuffer(dest));
+	cogl_set_viewport(0, 0, w, h);
+	cogl_ortho(0, w, h, 0, -1, 1);
+	cogl_set_modelview_matrix(&identity);
+	cogl_clear(&transparent, COGL_BUFFER_BIT_COLOR);
+	cogl_set_source(material);
+	cogl_rectangle(0, 0, w, h);
+	cogl_pop_framebuffer();
+}
@@ -0,0 +1,75 @@
+/*
+ *  ofxClutterCachedEffect.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterOffscreenPool.h"
+
+
+// Base for effects that render an actor offscreen and draw a processed
+// copy of it.  The actor is rendered in its own coordinates into a pooled
+// target, process() turns that into the image that's drawn, and both are
+// kept until something changes: while the actor and its children don't
+// queue a redraw and its paint opacity stays the same, the actor's paint
+// (its own and all its children's) is skipped and the cached result drawn
+// in its place.  Changing an
+// effect parameter calls invalidate(), which only re-runs process().
+class ofxClutterCachedEffect {
+public:
+	ofxClutterCachedEffect();
+	virtual ~ofxClutterCachedEffect();
+	
+	// An effect can be applied to one actor at a time
+	void apply(ofxClutterActor* target);
+	void remove();
+	
+	// Re-run process() on the cached source at the next paint
+	void invalidate();
+	// Re-render the actor at the next paint
+	void invalidateSource();
+	
+	int getNumCacheHits() { return numCacheHits; }		// paints that skipped the actor
+	int getNumRenders() { return numRenders; }
+	int getNumProcesses() { return numProcesses; }
+	void resetStats() { numCacheHits = numRenders = numProcesses = 0; }
+	
+	// Called by the Clutter effect
+	bool prePaint();
+	void postPaint();
+	void targetQueuedRedraw();
+	void targetDestroyed();
+	bool isSkippingPaint() { return skipping; }
+	
+protected:
+	// Returns the texture to draw: source itself or a target acquired from
+	// ofxClutterOffscreenPool, which the base releases when it's replaced.
+	virtual CoglHandle process(CoglHandle source, int w, int h) { return source; }
+	
+	// Draws material over the whole of dest, a pooled target
+	static void drawInto(CoglHandle dest, CoglMaterial* material);
+	
+	void queueRedraw();
+	void releaseTargets();
+	
+	ClutterEffect* effect;
+	ClutterActor* target;
+	gulong redrawHandler;
+	gulong paintHandler;
+	gulong destroyHandler;
+	bool queueingRedraw;
+	
+	CoglHandle source;
+	CoglHandle result;
+	CoglMaterial* material;
+	int width, height;
+	bool sourceValid, resultValid;
+	bool skipping;
+	guint8 sourceOpacity;
+	
+	int numCacheHits;
+	int numRenders;
+	int numProcesses;
+};
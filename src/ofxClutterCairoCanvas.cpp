@@ -0,0 +1,163 @@
+/*
+ *  ofxClutterCairoCanvas.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterCairoCanvas.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+// CAIRO_FORMAT_ARGB32 in memory order
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define CAIRO_PIXEL_FORMAT COGL_PIXEL_FORMAT_BGRA_8888_PRE
+#else
+#define CAIRO_PIXEL_FORMAT COGL_PIXEL_FORMAT_ARGB_8888_PRE
+#endif
+
+ofxClutterWorkerPool* ofxClutterCairoCanvas::pool = NULL;
+int ofxClutterCairoCanvas::numCanvases = 0;
+
+
+// Draws one tile into its own image surface on a worker thread
+class ofxClutterCairoTileJob : public ofxClutterJob {
+public:
+	ofxClutterCairoTileJob(ofxClutterCairoCanvas* owner, ofxClutterCairoPainter* painter, int tile, ofRectangle region)
+	: owner(owner), painter(painter), tile(tile), region(region), surface(NULL) {}
+	
+	~ofxClutterCairoTileJob() {
+		if(surface) cairo_surface_destroy(surface);
+	}
+	
+	void run() {
+		surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, region.width, region.height);
+		cairo_t* cr = cairo_create(surface);
+		cairo_translate(cr, -region.x, -region.y);
+		cairo_rectangle(cr, region.x, region.y, region.width, region.height);
+		cairo_clip(cr);
+		painter->draw(cr, region);
+		cairo_destroy(cr);
+		cairo_surface_flush(surface);
+	}
+	
+	void finish() {
+		owner->tileRendered(tile, surface);
+	}
+	
+	ofxClutterCairoCanvas* owner;
+	ofxClutterCairoPainter* painter;
+	int tile;
+	ofRectangle region;
+	cairo_surface_t* surface;
+};
+
+
+//------------------------------------------------------------
+ofxClutterCairoCanvas::ofxClutterCairoCanvas(int w, int h, ofxClutterCairoPainter* painter, int tileSize, int numThreads) {
+	if(numCanvases++ == 0) pool = new ofxClutterWorkerPool(numThreads);
+	
+	actor = clutter_cairo_texture_new(w, h);
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	
+	// An empty draw makes ClutterCairoTexture create its Cogl texture,
+	// which the tiles are then uploaded into.
+	cairo_destroy(clutter_cairo_texture_create(CLUTTER_CAIRO_TEXTURE(actor)));
+	
+	width = w;
+	height = h;
+	this->tileSize = tileSize;
+	this->painter = painter;
+	tilesX = (w + tileSize - 1) / tileSize;
+	tilesY = (h + tileSize - 1) / tileSize;
+	dirty.assign(tilesX * tilesY, true);
+	rendering.assign(tilesX * tilesY, false);
+	numRendering = 0;
+	numTilesUploaded = totalTilesUploaded = 0;
+}
+
+
+//------------------------------------------------------------
+// Tiles still being drawn use the painter and call back into this canvas,
+// so wait for them to land first.  Other canvases' tiles finished in the
+// meantime are uploaded as usual.
+ofxClutterCairoCanvas::~ofxClutterCairoCanvas() {
+	while(numRendering > 0) {
+		if(pool->finishJobs() == 0) g_usleep(1000);
+	}
+	clutter_actor_destroy(actor);
+	
+	if(--numCanvases == 0) {
+		delete pool;
+		pool = NULL;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCairoCanvas::invalidate() {
+	dirty.assign(dirty.size(), true);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCairoCanvas::invalidate(int x, int y, int w, int h) {
+	int x1 = MAX(x, 0) / tileSize;
+	int y1 = MAX(y, 0) / tileSize;
+	int x2 = MIN(x + w, width);
+	int y2 = MIN(y + h, height);
+	for(int ty=y1; ty*tileSize < y2; ty++) {
+		for(int tx=x1; tx*tileSize < x2; tx++) {
+			dirty[ty*tilesX + tx] = true;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+int ofxClutterCairoCanvas::getNumDirtyTiles() {
+	return count(dirty.begin(), dirty.end(), true);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCairoCanvas::update(int maxMillis) {
+	numTilesUploaded = 0;
+	pool->finishJobs(-1, maxMillis);
+	
+	// A tile that's dirtied again while drawing waits for that draw to
+	// land, then goes again; two jobs for one tile could finish out of order.
+	for(int i=0; i<dirty.size(); i++) {
+		if(!dirty[i] || rendering[i]) continue;
+		int x = (i % tilesX) * tileSize;
+		int y = (i / tilesX) * tileSize;
+		ofRectangle region(x, y, MIN(tileSize, width - x), MIN(tileSize, height - y));
+		dirty[i] = false;
+		rendering[i] = true;
+		numRendering++;
+		pool->push(new ofxClutterCairoTileJob(this, painter, i, region));
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterCairoCanvas::tileRendered(int tile, cairo_surface_t* surface) {
+	rendering[tile] = false;
+	numRendering--;
+	
+	CoglHandle tex = clutter_texture_get_cogl_texture(CLUTTER_TEXTURE(actor));
+	if(tex == COGL_INVALID_HANDLE) return;
+	
+	int w = cairo_image_surface_get_width(surface);
+	int h = cairo_image_surface_get_height(surface);
+	cogl_texture_set_region(tex, 0, 0, (tile % tilesX) * tileSize, (tile / tilesX) * tileSize, w, h, w, h,
+							CAIRO_PIXEL_FORMAT, cairo_image_surface_get_stride(surface),
+							cairo_image_surface_get_data(surface));
+	clutter_actor_queue_redraw(actor);
+	
+	numTilesUploaded++;
+	totalTilesUploaded++;
+}
@@ -0,0 +1,72 @@
+/*
+ *  ofxClutterCairoCanvas.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterWorkerPool.h"
+#include <cairo.h>
+
+
+// Draws the contents of an ofxClutterCairoCanvas.  draw() runs on worker
+// threads, several tiles at once, so it may only read shared data; don't
+// change that data while the canvas isBusy().
+class ofxClutterCairoPainter {
+public:
+	virtual ~ofxClutterCairoPainter() {}
+	
+	// cr is clipped to region and uses canvas coordinates
+	virtual void draw(cairo_t* cr, ofRectangle region) = 0;
+};
+
+
+// A ClutterCairoTexture split into tiles that are rasterized on worker
+// threads.  invalidate() marks the tiles under a rect as dirty; update()
+// hands dirty tiles to the pool and uploads finished ones straight into
+// the texture with cogl_texture_set_region, so a small change to a large
+// surface redraws and re-uploads only the tiles it touches.
+//
+// All canvases share one pool of threads, sized by the first canvas
+// created (0 threads means one per processor) and stopped with the last
+// one, so a dashboard of many charts doesn't start a pool per chart.
+// Any canvas's update() uploads finished tiles for all of them.
+class ofxClutterCairoCanvas : public ofxClutterActor {
+public:
+	ofxClutterCairoCanvas(int w, int h, ofxClutterCairoPainter* painter, int tileSize=256, int numThreads=0);
+	~ofxClutterCairoCanvas();
+	
+	void invalidate();
+	void invalidate(int x, int y, int w, int h);
+	void invalidate(ofRectangle r) { invalidate(r.x, r.y, r.width, r.height); }
+	
+	// Starts dirty tiles and uploads finished ones; call every frame
+	void update(int maxMillis=-1);
+	
+	// True while tiles are being drawn
+	bool isBusy() { return numRendering > 0; }
+	
+	int getNumTiles() { return tilesX * tilesY; }
+	int getNumDirtyTiles();
+	int getNumTilesUploaded() { return numTilesUploaded; }		// since the last update() started
+	int getTotalTilesUploaded() { return totalTilesUploaded; }
+	
+	// Called by the tile jobs
+	void tileRendered(int tile, cairo_surface_t* surface);
+	
+protected:
+	int width, height;
+	int tileSize;
+	int tilesX, tilesY;
+	ofxClutterCairoPainter* painter;
+	
+	vector<bool> dirty;
+	vector<bool> rendering;
+	int numRendering;
+	int numTilesUploaded;
+	int totalTilesUploaded;
+	
+	static ofxClutterWorkerPool* pool;
+	static int numCanvases;
+};
@@ -0,0 +1,250 @@
+/*
+ *  ofxClutterColor.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterColor.h"
+
+struct ofxClutterNamedColor {
+	guint32 hash;
+	const char* name;
+	guint8 r, g, b;
+};
+
+// FNV-1a hashes of the lowercase names, sorted by hash and generated
+// ahead of time, so a lookup is one hash and a binary search.
+static const ofxClutterNamedColor namedColors[] = {
+	{ 0x011decbcu, "green", 0x00, 0x80, 0x00 },
+	{ 0x0340e137u, "darkseagreen", 0x8f, 0xbc, 0x8f },
+	{ 0x03e1343au, "fuchsia", 0xff, 0x00, 0xff },
+	{ 0x042602eeu, "crimson", 0xdc, 0x14, 0x3c },
+	{ 0x043cb490u, "wheat", 0xf5, 0xde, 0xb3 },
+	{ 0x05b72af6u, "darkslateblue", 0x48, 0x3d, 0x8b },
+	{ 0x05bf6449u, "yellow", 0xff, 0xff, 0x00 },
+	{ 0x07e34bbcu, "lime", 0x00, 0xff, 0x00 },
+	{ 0x0817f94du, "darkblue", 0x00, 0x00, 0x8b },
+	{ 0x08a71a94u, "thistle", 0xd8, 0xbf, 0xd8 },
+	{ 0x0920e031u, "mintcream", 0xf5, 0xff, 0xfa },
+	{ 0x09357b30u, "lightskyblue", 0x87, 0xce, 0xfa },
+	{ 0x0ba64a14u, "mediumseagreen", 0x3c, 0xb3, 0x71 },
+	{ 0x0c376f3cu, "darkgreen", 0x00, 0x64, 0x00 },
+	{ 0x0d8329fcu, "greenyellow", 0xad, 0xff, 0x2f },
+	{ 0x0de1b599u, "slategrey", 0x70, 0x80, 0x90 },
+	{ 0x15d8c7d5u, "slategray", 0x70, 0x80, 0x90 },
+	{ 0x16ee77b1u, "blanchedalmond", 0xff, 0xeb, 0xcd },
+	{ 0x17c1a698u, "hotpink", 0xff, 0x69, 0xb4 },
+	{ 0x1a0e44adu, "mediumorchid", 0xba, 0x55, 0xd3 },
+	{ 0x1a236609u, "darkgoldenrod", 0xb8, 0x86, 0x0b },
+	{ 0x1bdaa4b0u, "mediumvioletred", 0xc7, 0x15, 0x85 },
+	{ 0x1c96ce4eu, "skyblue", 0x87, 0xce, 0xeb },
+	{ 0x1e17dfe8u, "rebeccapurple", 0x66, 0x33, 0x99 },
+	{ 0x1e8db068u, "darkmagenta", 0x8b, 0x00, 0x8b },
+	{ 0x1ed7a4eau, "cornsilk", 0xff, 0xf8, 0xdc },
+	{ 0x225e036du, "pink", 0xff, 0xc0, 0xcb },
+	{ 0x22d8ff1cu, "mediumaquamarine", 0x66, 0xcd, 0xaa },
+	{ 0x23b55208u, "lightgrey", 0xd3, 0xd3, 0xd3 },
+	{ 0x262562c3u, "aliceblue", 0xf0, 0xf8, 0xff },
+	{ 0x29f41e26u, "dimgray", 0x69, 0x69, 0x69 },
+	{ 0x2bbe58fcu, "lightgray", 0xd3, 0xd3, 0xd3 },
+	{ 0x30be372fu, "brown", 0xa5, 0x2a, 0x2a },
+	{ 0x31feb81au, "dimgrey", 0x69, 0x69, 0x69 },
+	{ 0x3227246bu, "sienna", 0xa0, 0x52, 0x2d },
+	{ 0x32db86dfu, "darksalmon", 0xe9, 0x96, 0x7a },
+	{ 0x35a2e5c3u, "tomato", 0xff, 0x63, 0x47 },
+	{ 0x3758c2e0u, "azure", 0xf0, 0xff, 0xff },
+	{ 0x37ac1d26u, "darkgrey", 0xa9, 0xa9, 0xa9 },
+	{ 0x38540573u, "beige", 0xf5, 0xf5, 0xdc },
+	{ 0x39b3175fu, "salmon", 0xfa, 0x80, 0x72 },
+	{ 0x3bb34073u, "lightslategrey", 0x77, 0x88, 0x99 },
+	{ 0x3edce36bu, "darkorange", 0xff, 0x8c, 0x00 },
+	{ 0x3fb6b71au, "darkgray", 0xa9, 0xa9, 0xa9 },
+	{ 0x40f480dcu, "red", 0xff, 0x00, 0x00 },
+	{ 0x419e5a8au, "blueviolet", 0x8a, 0x2b, 0xe2 },
+	{ 0x42374f95u, "aqua", 0x00, 0xff, 0xff },
+	{ 0x429bb099u, "chocolate", 0xd2, 0x69, 0x1e },
+	{ 0x43bdda67u, "lightslategray", 0x77, 0x88, 0x99 },
+	{ 0x45658504u, "moccasin", 0xff, 0xe4, 0xb5 },
+	{ 0x45b473ebu, "orange", 0xff, 0xa5, 0x00 },
+	{ 0x46aadbdeu, "seashell", 0xff, 0xf5, 0xee },
+	{ 0x480fb75eu, "cadetblue", 0x5f, 0x9e, 0xa0 },
+	{ 0x4961533au, "cyan", 0x00, 0xff, 0xff },
+	{ 0x4c7a1b8fu, "navajowhite", 0xff, 0xde, 0xad },
+	{ 0x4d77512bu, "indigo", 0x4b, 0x00, 0x82 },
+	{ 0x4efa960cu, "lightcoral", 0xf0, 0x80, 0x80 },
+	{ 0x4f9530f7u, "deeppink", 0xff, 0x14, 0x93 },
+	{ 0x51b1437eu, "dodgerblue", 0x1e, 0x90, 0xff },
+	{ 0x54408ac8u, "steelblue", 0x46, 0x82, 0xb4 },
+	{ 0x559a4808u, "cornflowerblue", 0x64, 0x95, 0xed },
+	{ 0x568f4ba4u, "black", 0x00, 0x00, 0x00 },
+	{ 0x5cabe370u, "deepskyblue", 0x00, 0xbf, 0xff },
+	{ 0x5f247ea7u, "limegreen", 0x32, 0xcd, 0x32 },
+	{ 0x6021b659u, "palegoldenrod", 0xee, 0xe8, 0xaa },
+	{ 0x60605b18u, "honeydew", 0xf0, 0xff, 0xf0 },
+	{ 0x63e629e8u, "magenta", 0xff, 0x00, 0xff },
+	{ 0x66bc38ddu, "chartreuse", 0x7f, 0xff, 0x00 },
+	{ 0x677785b6u, "firebrick", 0xb2, 0x22, 0x22 },
+	{ 0x699ce1b7u, "lightpink", 0xff, 0xb6, 0xc1 },
+	{ 0x6d9b9752u, "coral", 0xff, 0x7f, 0x50 },
+	{ 0x6e32ccf5u, "maroon", 0x80, 0x00, 0x00 },
+	{ 0x6fdd84bcu, "powderblue", 0xb0, 0xe0, 0xe6 },
+	{ 0x714b1745u, "lightsalmon", 0xff, 0xa0, 0x7a },
+	{ 0x71780822u, "mediumspringgreen", 0x00, 0xfa, 0x9a },
+	{ 0x719339b9u, "khaki", 0xf0, 0xe6, 0x8c },
+	{ 0x7495c772u, "darkviolet", 0x94, 0x00, 0xd3 },
+	{ 0x7538805au, "turquoise", 0x40, 0xe0, 0xd0 },
+	{ 0x772890e7u, "mediumslateblue", 0x7b, 0x68, 0xee },
+	{ 0x7b6d57f2u, "violet", 0xee, 0x82, 0xee },
+	{ 0x7b75476au, "sandybrown", 0xf4, 0xa4, 0x60 },
+	{ 0x7cacbc39u, "darkkhaki", 0xbd, 0xb7, 0x6b },
+	{ 0x7fb0e019u, "darkslategrey", 0x2f, 0x4f, 0x4f },
+	{ 0x82e33fb4u, "floralwhite", 0xff, 0xfa, 0xf0 },
+	{ 0x82fbf5cdu, "blue", 0x00, 0x00, 0xff },
+	{ 0x835cd3ccu, "olive", 0x80, 0x80, 0x00 },
+	{ 0x848317f2u, "snow", 0xff, 0xfa, 0xfa },
+	{ 0x87a7f255u, "darkslategray", 0x2f, 0x4f, 0x4f },
+	{ 0x8989e5feu, "lightsteelblue", 0xb0, 0xc4, 0xde },
+	{ 0x8bb2ab96u, "lawngreen", 0x7c, 0xfc, 0x00 },
+	{ 0x8c361729u, "papayawhip", 0xff, 0xef, 0xd5 },
+	{ 0x8e1fedccu, "palegreen", 0x98, 0xfb, 0x98 },
+	{ 0x9049cd77u, "darkolivegreen", 0x55, 0x6b, 0x2f },
+	{ 0x907d3a11u, "palevioletred", 0xdb, 0x70, 0x93 },
+	{ 0x93e80076u, "slateblue", 0x6a, 0x5a, 0xcd },
+	{ 0x952635e8u, "burlywood", 0xde, 0xb8, 0x87 },
+	{ 0x97e0985au, "orangered", 0xff, 0x45, 0x00 },
+	{ 0x9807620du, "indianred", 0xcd, 0x5c, 0x5c },
+	{ 0x9a6e02ffu, "purple", 0x80, 0x00, 0x80 },
+	{ 0x9b55348du, "oldlace", 0xfd, 0xf5, 0xe6 },
+	{ 0x9c3f19c6u, "lightgreen", 0x90, 0xee, 0x90 },
+	{ 0x9cf73498u, "tan", 0xd2, 0xb4, 0x8c },
+	{ 0x9dea06b6u, "ivory", 0xff, 0xff, 0xf0 },
+	{ 0xa0fff1d1u, "navy", 0x00, 0x00, 0x80 },
+	{ 0xa124f36bu, "lightyellow", 0xff, 0xff, 0xe0 },
+	{ 0xa3fd7e9fu, "teal", 0x00, 0x80, 0x80 },
+	{ 0xa60f29bau, "darkorchid", 0x99, 0x32, 0xcc },
+	{ 0xa8543b89u, "goldenrod", 0xda, 0xa5, 0x20 },
+	{ 0xa9362f24u, "mediumpurple", 0x93, 0x70, 0xdb },
+	{ 0xa9ddfd93u, "lemonchiffon", 0xff, 0xfa, 0xcd },
+	{ 0xaa3e3a1fu, "whitesmoke", 0xf5, 0xf5, 0xf5 },
+	{ 0xace6ba3au, "orchid", 0xda, 0x70, 0xd6 },
+	{ 0xad8825b7u, "seagreen", 0x2e, 0x8b, 0x57 },
+	{ 0xb29019a6u, "grey", 0x80, 0x80, 0x80 },
+	{ 0xb2f7293fu, "lightgoldenrodyellow", 0xfa, 0xfa, 0xd2 },
+	{ 0xb351bdbdu, "olivedrab", 0x6b, 0x8e, 0x23 },
+	{ 0xb554f920u, "silver", 0xc0, 0xc0, 0xc0 },
+	{ 0xb6adb06bu, "plum", 0xdd, 0xa0, 0xdd },
+	{ 0xb6b77908u, "yellowgreen", 0x9a, 0xcd, 0x32 },
+	{ 0xb8ea87d3u, "forestgreen", 0x22, 0x8b, 0x22 },
+	{ 0xb8f04003u, "peru", 0xcd, 0x85, 0x3f },
+	{ 0xb928b3eeu, "lavender", 0xe6, 0xe6, 0xfa },
+	{ 0xba9ab39au, "gray", 0x80, 0x80, 0x80 },
+	{ 0xbfbdf46cu, "royalblue", 0x41, 0x69, 0xe1 },
+	{ 0xc17f9b3au, "bisque", 0xff, 0xe4, 0xc4 },
+	{ 0xc370be3bu, "lightblue", 0xad, 0xd8, 0xe6 },
+	{ 0xcbdc3f67u, "mediumturquoise", 0x48, 0xd1, 0xcc },
+	{ 0xcc8e0751u, "midnightblue", 0x19, 0x19, 0x70 },
+	{ 0xcc91efcau, "paleturquoise", 0xaf, 0xee, 0xee },
+	{ 0xcd4bddcfu, "antiquewhite", 0xfa, 0xeb, 0xd7 },
+	{ 0xce7d56bau, "darkcyan", 0x00, 0x8b, 0x8b },
+	{ 0xd57e7bfdu, "ghostwhite", 0xf8, 0xf8, 0xff },
+	{ 0xd591a34cu, "lavenderblush", 0xff, 0xf0, 0xf5 },
+	{ 0xd6e414ebu, "linen", 0xfa, 0xf0, 0xe6 },
+	{ 0xde020766u, "white", 0xff, 0xff, 0xff },
+	{ 0xe15092fbu, "gainsboro", 0xdc, 0xdc, 0xdc },
+	{ 0xe1858adcu, "mistyrose", 0xff, 0xe4, 0xe1 },
+	{ 0xe243e671u, "lightseagreen", 0x20, 0xb2, 0xaa },
+	{ 0xe707aadau, "darkturquoise", 0x00, 0xce, 0xd1 },
+	{ 0xe800849au, "saddlebrown", 0x8b, 0x45, 0x13 },
+	{ 0xe92d961du, "peachpuff", 0xff, 0xda, 0xb9 },
+	{ 0xebd89f5cu, "darkred", 0x8b, 0x00, 0x00 },
+	{ 0xec66d793u, "gold", 0xff, 0xd7, 0x00 },
+	{ 0xf060b994u, "lightcyan", 0xe0, 0xff, 0xff },
+	{ 0xf3aa9557u, "aquamarine", 0x7f, 0xff, 0xd4 },
+	{ 0xf79b7417u, "springgreen", 0x00, 0xff, 0x7f },
+	{ 0xf8d1f5a6u, "rosybrown", 0xbc, 0x8f, 0x8f },
+	{ 0xfdec2a8eu, "mediumblue", 0x00, 0x00, 0xcd },
+};
+
+static const int numNamedColors = sizeof(namedColors) / sizeof(namedColors[0]);
+
+
+//------------------------------------------------------------
+static inline char lower(char c) {
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+
+//------------------------------------------------------------
+static inline int hexValue(char c) {
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+
+//------------------------------------------------------------
+static bool parseHex(const char* str, ClutterColor& out) {
+	int digits[8];
+	int n = 0;
+	for(; str[n]; n++) {
+		if(n == 8 || (digits[n] = hexValue(str[n])) < 0) return false;
+	}
+	
+	switch(n) {
+		case 3:
+		case 4:
+			out.red = digits[0] * 17;
+			out.green = digits[1] * 17;
+			out.blue = digits[2] * 17;
+			out.alpha = (n == 4) ? digits[3] * 17 : 255;
+			return true;
+		case 6:
+		case 8:
+			out.red = digits[0] << 4 | digits[1];
+			out.green = digits[2] << 4 | digits[3];
+			out.blue = digits[4] << 4 | digits[5];
+			out.alpha = (n == 8) ? digits[6] << 4 | digits[7] : 255;
+			return true;
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+// Compares a table name with the input the same way it was hashed
+static bool nameMatches(const char* name, const char* str) {
+	for(; *str; str++) {
+		if(*str == ' ') continue;
+		if(*name++ != lower(*str)) return false;
+	}
+	return *name == '\0';
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterColor::parse(const char* str, ClutterColor& out) {
+	if(str[0] == '#') return parseHex(str + 1, out);
+	
+	guint32 hash = 2166136261u;
+	for(const char* c = str; *c; c++) {
+		if(*c == ' ') continue;
+		hash = (hash ^ (guint8)lower(*c)) * 16777619u;
+	}
+	
+	int lo = 0, hi = numNamedColors;
+	while(lo < hi) {
+		int mid = (lo + hi) / 2;
+		if(namedColors[mid].hash < hash) lo = mid + 1;
+		else hi = mid;
+	}
+	if(lo == numNamedColors || namedColors[lo].hash != hash || !nameMatches(namedColors[lo].name, str)) {
+		return false;
+	}
+	
+	out.red = namedColors[lo].r;
+	out.green = namedColors[lo].g;
+	out.blue = namedColors[lo].b;
+	out.alpha = 255;
+	return true;
+}
@@ -0,0 +1,20 @@
+/*
+ *  ofxClutterColor.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include <clutter/clutter.h>
+
+
+// Parses color strings without allocating: the 148 CSS named colors
+// (which include the X11 names), case-insensitive and ignoring spaces, so
+// "Dark Slate Gray" works too, or #rgb, #rgba, #rrggbb and #rrggbbaa.
+class ofxClutterColor {
+public:
+	// Leaves out untouched and returns false if str isn't a color
+	static bool parse(const char* str, ClutterColor& out);
+	static bool parse(const string& str, ClutterColor& out) { return parse(str.c_str(), out); }
+};
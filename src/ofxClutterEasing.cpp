@@ -0,0 +1,392 @@
+/*
+ *  ofxClutterEasing.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterEasing.h"
+
+static const float backOvershoot = 1.70158f;
+
+
+//------------------------------------------------------------
+static inline float bounceOut(float p) {
+	if(p < 1 / 2.75f) {
+		return 7.5625f * p * p;
+	}
+	else if(p < 2 / 2.75f) {
+		p -= 1.5f / 2.75f;
+		return 7.5625f * p * p + .75f;
+	}
+	else if(p < 2.5f / 2.75f) {
+		p -= 2.25f / 2.75f;
+		return 7.5625f * p * p + .9375f;
+	}
+	p -= 2.625f / 2.75f;
+	return 7.5625f * p * p + .984375f;
+}
+
+
+//------------------------------------------------------------
+// Elastic modes: period .3 (.45 for in-out) and a quarter period of phase
+static inline float elastic(float q, float period) {
+	return powf(2, 10 * q) * sinf((q - period / 4) * (2 * (float)M_PI) / period);
+}
+
+
+//------------------------------------------------------------
+float ofxClutterEasing::evaluate(int mode, float p) {
+	float q;
+	switch(mode) {
+		case CLUTTER_LINEAR:
+			return p;
+			
+		case CLUTTER_EASE_IN_QUAD:
+			return p * p;
+		case CLUTTER_EASE_OUT_QUAD:
+			return -p * (p - 2);
+		case CLUTTER_EASE_IN_OUT_QUAD:
+			q = p * 2;
+			if(q < 1) return .5f * q * q;
+			q -= 1;
+			return -.5f * (q * (q - 2) - 1);
+			
+		case CLUTTER_EASE_IN_CUBIC:
+			return p * p * p;
+		case CLUTTER_EASE_OUT_CUBIC:
+			q = p - 1;
+			return q * q * q + 1;
+		case CLUTTER_EASE_IN_OUT_CUBIC:
+			q = p * 2;
+			if(q < 1) return .5f * q * q * q;
+			q -= 2;
+			return .5f * (q * q * q + 2);
+			
+		case CLUTTER_EASE_IN_QUART:
+			return p * p * p * p;
+		case CLUTTER_EASE_OUT_QUART:
+			q = p - 1;
+			return -(q * q * q * q - 1);
+		case CLUTTER_EASE_IN_OUT_QUART:
+			q = p * 2;
+			if(q < 1) return .5f * q * q * q * q;
+			q -= 2;
+			return -.5f * (q * q * q * q - 2);
+			
+		case CLUTTER_EASE_IN_QUINT:
+			return p * p * p * p * p;
+		case CLUTTER_EASE_OUT_QUINT:
+			q = p - 1;
+			return q * q * q * q * q + 1;
+		case CLUTTER_EASE_IN_OUT_QUINT:
+			q = p * 2;
+			if(q < 1) return .5f * q * q * q * q * q;
+			q -= 2;
+			return .5f * (q * q * q * q * q + 2);
+			
+		case CLUTTER_EASE_IN_SINE:
+			return 1 - cosf(p * (float)M_PI / 2);
+		case CLUTTER_EASE_OUT_SINE:
+			return sinf(p * (float)M_PI / 2);
+		case CLUTTER_EASE_IN_OUT_SINE:
+			return -.5f * (cosf((float)M_PI * p) - 1);
+			
+		case CLUTTER_EASE_IN_EXPO:
+			return (p == 0) ? 0 : powf(2, 10 * (p - 1));
+		case CLUTTER_EASE_OUT_EXPO:
+			return (p == 1) ? 1 : 1 - powf(2, -10 * p);
+		case CLUTTER_EASE_IN_OUT_EXPO:
+			if(p == 0) return 0;
+			if(p == 1) return 1;
+			q = p * 2;
+			if(q < 1) return .5f * powf(2, 10 * (q - 1));
+			q -= 1;
+			return .5f * (2 - powf(2, -10 * q));
+			
+		case CLUTTER_EASE_IN_CIRC:
+			return 1 - sqrtf(1 - p * p);
+		case CLUTTER_EASE_OUT_CIRC:
+			q = p - 1;
+			return sqrtf(1 - q * q);
+		case CLUTTER_EASE_IN_OUT_CIRC:
+			q = p * 2;
+			if(q < 1) return -.5f * (sqrtf(1 - q * q) - 1);
+			q -= 2;
+			return .5f * (sqrtf(1 - q * q) + 1);
+			
+		case CLUTTER_EASE_IN_ELASTIC:
+			if(p == 1) return 1;
+			return -elastic(p - 1, .3f);
+		case CLUTTER_EASE_OUT_ELASTIC:
+			if(p == 1) return 1;
+			return powf(2, -10 * p) * sinf((p - .3f / 4) * (2 * (float)M_PI) / .3f) + 1;
+		case CLUTTER_EASE_IN_OUT_ELASTIC:
+			q = p * 2;
+			if(q == 2) return 1;
+			if(q < 1) return -.5f * elastic(q - 1, .45f);
+			return .5f * powf(2, -10 * (q - 1)) * sinf((q - 1 - .45f / 4) * (2 * (float)M_PI) / .45f) + 1;
+			
+		case CLUTTER_EASE_IN_BACK:
+			return p * p * ((backOvershoot + 1) * p - backOvershoot);
+		case CLUTTER_EASE_OUT_BACK:
+			q = p - 1;
+			return q * q * ((backOvershoot + 1) * q + backOvershoot) + 1;
+		case CLUTTER_EASE_IN_OUT_BACK: {
+			float s = backOvershoot * 1.525f;
+			q = p * 2;
+			if(q < 1) return .5f * (q * q * ((s + 1) * q - s));
+			q -= 2;
+			return .5f * (q * q * ((s + 1) * q + s) + 2);
+		}
+			
+		case CLUTTER_EASE_IN_BOUNCE:
+			return 1 - bounceOut(1 - p);
+		case CLUTTER_EASE_OUT_BOUNCE:
+			return bounceOut(p);
+		case CLUTTER_EASE_IN_OUT_BOUNCE:
+			if(p < .5f) return .5f * (1 - bounceOut(1 - p * 2));
+			return .5f * bounceOut(p * 2 - 1) + .5f;
+	}
+	return p;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterEasing::evaluateScalar(int mode, const float* in, float* out, int n) {
+	for(int i=0; i<n; i++) out[i] = evaluate(mode, in[i]);
+}
+
+
+// Vector versions of the polynomial, circular, back and bounce modes.
+// Each instruction set is wrapped in the same handful of operations so the
+// curves are written once; branches become a compare and a select.  Sine,
+// expo and elastic need transcendentals and stay scalar.
+#if defined(__AVX__)
+#include <immintrin.h>
+struct ofxClutterEasingVec {
+	typedef __m256 T;
+	typedef __m256 Mask;
+	enum { N = 8 };
+	static const char* name() { return "AVX"; }
+	static T load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, T a) { _mm256_storeu_ps(p, a); }
+	static T set(float f) { return _mm256_set1_ps(f); }
+	static T add(T a, T b) { return _mm256_add_ps(a, b); }
+	static T sub(T a, T b) { return _mm256_sub_ps(a, b); }
+	static T mul(T a, T b) { return _mm256_mul_ps(a, b); }
+	static T sqrt(T a) { return _mm256_sqrt_ps(_mm256_max_ps(a, _mm256_setzero_ps())); }
+	static Mask lt(T a, T b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static T select(Mask m, T a, T b) { return _mm256_blendv_ps(b, a, m); }
+};
+#define OFX_CLUTTER_EASING_SIMD
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+struct ofxClutterEasingVec {
+	typedef __m128 T;
+	typedef __m128 Mask;
+	enum { N = 4 };
+	static const char* name() { return "SSE2"; }
+	static T load(const float* p) { return _mm_loadu_ps(p); }
+	static void store(float* p, T a) { _mm_storeu_ps(p, a); }
+	static T set(float f) { return _mm_set1_ps(f); }
+	static T add(T a, T b) { return _mm_add_ps(a, b); }
+	static T sub(T a, T b) { return _mm_sub_ps(a, b); }
+	static T mul(T a, T b) { return _mm_mul_ps(a, b); }
+	static T sqrt(T a) { return _mm_sqrt_ps(_mm_max_ps(a, _mm_setzero_ps())); }
+	static Mask lt(T a, T b) { return _mm_cmplt_ps(a, b); }
+	static T select(Mask m, T a, T b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+#define OFX_CLUTTER_EASING_SIMD
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+struct ofxClutterEasingVec {
+	typedef float32x4_t T;
+	typedef uint32x4_t Mask;
+	enum { N = 4 };
+	static const char* name() { return "NEON"; }
+	static T load(const float* p) { return vld1q_f32(p); }
+	static void store(float* p, T a) { vst1q_f32(p, a); }
+	static T set(float f) { return vdupq_n_f32(f); }
+	static T add(T a, T b) { return vaddq_f32(a, b); }
+	static T sub(T a, T b) { return vsubq_f32(a, b); }
+	static T mul(T a, T b) { return vmulq_f32(a, b); }
+	static T sqrt(T a) {
+		a = vmaxq_f32(a, vdupq_n_f32(0));
+#if defined(__aarch64__)
+		return vsqrtq_f32(a);
+#else
+		// a * 1/sqrt(a) with two Newton steps; zero stays zero
+		float32x4_t r = vrsqrteq_f32(a);
+		r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+		r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+		return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0)), a, vmulq_f32(a, r));
+#endif
+	}
+	static Mask lt(T a, T b) { return vcltq_f32(a, b); }
+	static T select(Mask m, T a, T b) { return vbslq_f32(m, a, b); }
+};
+#define OFX_CLUTTER_EASING_SIMD
+#endif
+
+
+#ifdef OFX_CLUTTER_EASING_SIMD
+typedef ofxClutterEasingVec V;
+typedef V::T Vf;
+
+//------------------------------------------------------------
+static inline Vf pow2(Vf p) { return V::mul(p, p); }
+static inline Vf pow3(Vf p) { return V::mul(pow2(p), p); }
+static inline Vf pow4(Vf p) { return pow2(pow2(p)); }
+static inline Vf pow5(Vf p) { return V::mul(pow4(p), p); }
+
+
+//------------------------------------------------------------
+static inline Vf powN(Vf p, int n) {
+	switch(n) {
+		case 2: return pow2(p);
+		case 3: return pow3(p);
+		case 4: return pow4(p);
+	}
+	return pow5(p);
+}
+
+
+//------------------------------------------------------------
+// In, out and in-out for p^n; odd and even powers mirror differently
+static inline Vf polyIn(Vf p, int n) {
+	return powN(p, n);
+}
+
+
+//------------------------------------------------------------
+static inline Vf polyOut(Vf p, int n) {
+	Vf q = V::sub(p, V::set(1));
+	if(n % 2) return V::add(powN(q, n), V::set(1));
+	return V::sub(V::set(1), powN(q, n));
+}
+
+
+//------------------------------------------------------------
+static inline Vf polyInOut(Vf p, int n) {
+	Vf q = V::add(p, p);
+	Vf lo = V::mul(V::set(.5f), powN(q, n));
+	Vf q2 = V::sub(q, V::set(2));
+	Vf hi = (n % 2) ? V::mul(V::set(.5f), V::add(powN(q2, n), V::set(2)))
+					: V::mul(V::set(-.5f), V::sub(powN(q2, n), V::set(2)));
+	return V::select(V::lt(q, V::set(1)), lo, hi);
+}
+
+
+//------------------------------------------------------------
+static inline Vf bounceOut(Vf p) {
+	Vf k = V::set(7.5625f);
+	Vf a = V::mul(k, pow2(p));
+	Vf b = V::add(V::mul(k, pow2(V::sub(p, V::set(1.5f / 2.75f)))), V::set(.75f));
+	Vf c = V::add(V::mul(k, pow2(V::sub(p, V::set(2.25f / 2.75f)))), V::set(.9375f));
+	Vf d = V::add(V::mul(k, pow2(V::sub(p, V::set(2.625f / 2.75f)))), V::set(.984375f));
+	Vf r = V::select(V::lt(p, V::set(2.5f / 2.75f)), c, d);
+	r = V::select(V::lt(p, V::set(2 / 2.75f)), b, r);
+	return V::select(V::lt(p, V::set(1 / 2.75f)), a, r);
+}
+
+
+//------------------------------------------------------------
+static inline Vf backIn(Vf p, float s) {
+	return V::mul(pow2(p), V::sub(V::mul(V::set(s + 1), p), V::set(s)));
+}
+
+
+//------------------------------------------------------------
+static inline Vf backOut(Vf q, float s) {
+	return V::add(V::mul(pow2(q), V::add(V::mul(V::set(s + 1), q), V::set(s))), V::set(1));
+}
+
+
+//------------------------------------------------------------
+static inline Vf evaluateVec(int mode, Vf p) {
+	Vf one = V::set(1);
+	Vf half = V::set(.5f);
+	switch(mode) {
+		case CLUTTER_EASE_IN_QUAD:			return polyIn(p, 2);
+		case CLUTTER_EASE_OUT_QUAD:			return V::mul(p, V::sub(V::set(2), p));
+		case CLUTTER_EASE_IN_OUT_QUAD: {
+			Vf q = V::add(p, p);
+			Vf q2 = V::sub(q, one);
+			Vf hi = V::mul(V::set(-.5f), V::sub(V::mul(q2, V::sub(q2, V::set(2))), one));
+			return V::select(V::lt(q, one), V::mul(half, pow2(q)), hi);
+		}
+		case CLUTTER_EASE_IN_CUBIC:			return polyIn(p, 3);
+		case CLUTTER_EASE_OUT_CUBIC:		return polyOut(p, 3);
+		case CLUTTER_EASE_IN_OUT_CUBIC:		return polyInOut(p, 3);
+		case CLUTTER_EASE_IN_QUART:			return polyIn(p, 4);
+		case CLUTTER_EASE_OUT_QUART:		return polyOut(p, 4);
+		case CLUTTER_EASE_IN_OUT_QUART:		return polyInOut(p, 4);
+		case CLUTTER_EASE_IN_QUINT:			return polyIn(p, 5);
+		case CLUTTER_EASE_OUT_QUINT:		return polyOut(p, 5);
+		case CLUTTER_EASE_IN_OUT_QUINT:		return polyInOut(p, 5);
+			
+		case CLUTTER_EASE_IN_CIRC:			return V::sub(one, V::sqrt(V::sub(one, pow2(p))));
+		case CLUTTER_EASE_OUT_CIRC:			return V::sqrt(V::sub(one, pow2(V::sub(p, one))));
+		case CLUTTER_EASE_IN_OUT_CIRC: {
+			Vf q = V::add(p, p);
+			Vf lo = V::mul(V::set(-.5f), V::sub(V::sqrt(V::sub(one, pow2(q))), one));
+			Vf hi = V::mul(half, V::add(V::sqrt(V::sub(one, pow2(V::sub(q, V::set(2))))), one));
+			return V::select(V::lt(q, one), lo, hi);
+		}
+			
+		case CLUTTER_EASE_IN_BACK:			return backIn(p, backOvershoot);
+		case CLUTTER_EASE_OUT_BACK:			return backOut(V::sub(p, one), backOvershoot);
+		case CLUTTER_EASE_IN_OUT_BACK: {
+			float s = backOvershoot * 1.525f;
+			Vf q = V::add(p, p);
+			Vf lo = V::mul(half, backIn(q, s));
+			Vf hi = V::mul(half, V::add(V::sub(backOut(V::sub(q, V::set(2)), s), one), V::set(2)));
+			return V::select(V::lt(q, one), lo, hi);
+		}
+			
+		case CLUTTER_EASE_IN_BOUNCE:		return V::sub(one, bounceOut(V::sub(one, p)));
+		case CLUTTER_EASE_OUT_BOUNCE:		return bounceOut(p);
+		case CLUTTER_EASE_IN_OUT_BOUNCE: {
+			Vf p2 = V::add(p, p);
+			Vf lo = V::mul(half, V::sub(one, bounceOut(V::sub(one, p2))));
+			Vf hi = V::add(V::mul(half, bounceOut(V::sub(p2, one))), half);
+			return V::select(V::lt(p, half), lo, hi);
+		}
+	}
+	return p;
+}
+
+
+//------------------------------------------------------------
+static bool isVectorized(int mode) {
+	return (mode >= CLUTTER_LINEAR && mode <= CLUTTER_EASE_IN_OUT_QUINT)
+		|| (mode >= CLUTTER_EASE_IN_CIRC && mode <= CLUTTER_EASE_IN_OUT_CIRC)
+		|| (mode >= CLUTTER_EASE_IN_BACK && mode <= CLUTTER_EASE_IN_OUT_BOUNCE);
+}
+#endif
+
+
+//------------------------------------------------------------
+void ofxClutterEasing::evaluate(int mode, const float* in, float* out, int n) {
+#ifdef OFX_CLUTTER_EASING_SIMD
+	if(isVectorized(mode)) {
+		int i = 0;
+		for(; i + V::N <= n; i += V::N) {
+			V::store(out + i, evaluateVec(mode, V::load(in + i)));
+		}
+		evaluateScalar(mode, in + i, out + i, n - i);
+		return;
+	}
+#endif
+	evaluateScalar(mode, in, out, n);
+}
+
+
+//------------------------------------------------------------
+const char* ofxClutterEasing::getInstructionSet() {
+#ifdef OFX_CLUTTER_EASING_SIMD
+	return V::name();
+#else
+	return "scalar";
+#endif
+}
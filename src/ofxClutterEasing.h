@@ -0,0 +1,31 @@
+/*
+ *  ofxClutterEasing.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include <clutter/clutter.h>
+
+
+// The ClutterAnimationMode curves (CLUTTER_LINEAR, CLUTTER_EASE_IN_CUBIC
+// and so on) as plain functions of progress, without a ClutterAlpha or a
+// timeline, for code that animates many values itself.  They follow the
+// formulas in clutter-alpha.c.
+class ofxClutterEasing {
+public:
+	// Progress t is 0..1; the result can overshoot for elastic and back modes
+	static float evaluate(int mode, float t);
+	
+	// Evaluates n progress values with the same mode; in and out may be the
+	// same array.  Uses AVX, SSE2 or NEON when the build targets them (the
+	// sine, expo and elastic modes are always scalar), evaluateScalar() otherwise.
+	static void evaluate(int mode, const float* in, float* out, int n);
+	static void evaluateScalar(int mode, const float* in, float* out, int n);
+	
+	// "AVX", "SSE2", "NEON" or "scalar"
+	static const char* getInstructionSet();
+	
+	static bool isSupported(int mode) { return mode >= CLUTTER_LINEAR && mode < CLUTTER_ANIMATION_LAST; }
+};
@@ -0,0 +1,236 @@
+/*
+ *  ofxClutterEffectChain.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterEffectChain.h"
+
+#define LUMINANCE_GLSL "dot(color.rgb, vec3(0.299, 0.587, 0.114))"
+
+
+//------------------------------------------------------------
+ofxClutterEffectChain::ofxClutterEffectChain() {
+	passesDirty = false;
+}
+
+
+//------------------------------------------------------------
+ofxClutterEffectChain::~ofxClutterEffectChain() {
+	remove();
+	releasePasses();
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addDesaturate(float factor) {
+	return addStage(false,
+					"float l = " LUMINANCE_GLSL ";\n"
+					"color.rgb = mix(color.rgb, vec3(l), param.x);\n",
+					factor, 0, 0, 0);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addColorize(int r, int g, int b) {
+	return addStage(false,
+					"color.rgb = " LUMINANCE_GLSL " * param.rgb;\n",
+					r / 255.0f, g / 255.0f, b / 255.0f, 0);
+}
+
+
+//------------------------------------------------------------
+// Brightness is added and contrast scales around mid gray, both on
+// unpremultiplied color
+int ofxClutterEffectChain::addBrightnessContrast(float brightness, float contrast) {
+	return addStage(false,
+					"if(color.a > 0.0) {\n"
+					"  vec3 c = color.rgb / color.a;\n"
+					"  c = (c - 0.5) * param.y + 0.5 + param.x;\n"
+					"  color.rgb = clamp(c, 0.0, 1.0) * color.a;\n"
+					"}\n",
+					brightness, contrast, 0, 0);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addBoxBlur(float radius) {
+	return addStage(true,
+					"color = vec4(0.0);\n"
+					"for(int y=-1; y<=1; y++) {\n"
+					"  for(int x=-1; x<=1; x++) {\n"
+					"    color += texture2D(tex, coord + vec2(float(x), float(y)) * texel * param.x);\n"
+					"  }\n"
+					"}\n"
+					"color /= 9.0;\n",
+					radius, 0, 0, 0);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addColorStage(string glsl) {
+	return addStage(false, glsl, 0, 0, 0, 0);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addSampleStage(string glsl) {
+	return addStage(true, glsl, 0, 0, 0, 0);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::addStage(bool sampling, string glsl, float x, float y, float z, float w) {
+	Stage s;
+	s.sampling = sampling;
+	s.glsl = glsl;
+	s.params[0] = x;
+	s.params[1] = y;
+	s.params[2] = z;
+	s.params[3] = w;
+	stages.push_back(s);
+	passesDirty = true;
+	invalidate();
+	return stages.size() - 1;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterEffectChain::setParams(int stage, float x, float y, float z, float w) {
+	if(stage < 0 || stage >= stages.size()) return;
+	float* p = stages[stage].params;
+	if(p[0] == x && p[1] == y && p[2] == z && p[3] == w) return;
+	p[0] = x;
+	p[1] = y;
+	p[2] = z;
+	p[3] = w;
+	invalidate();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterEffectChain::clear() {
+	stages.clear();
+	passesDirty = true;
+	invalidate();
+}
+
+
+//------------------------------------------------------------
+int ofxClutterEffectChain::getNumPasses() {
+	if(passesDirty) buildPasses();
+	return passes.size();
+}
+
+
+//------------------------------------------------------------
+// Splits the stages into passes: a pass starts with the first stage or a
+// sampling stage and takes every color stage after it.
+void ofxClutterEffectChain::buildPasses() {
+	releasePasses();
+	passesDirty = false;
+	
+	for(int i=0; i<stages.size(); ) {
+		Pass pass;
+		pass.firstStage = i;
+		pass.numStages = 1;
+		while(i + pass.numStages < stages.size() && !stages[i + pass.numStages].sampling) pass.numStages++;
+		i += pass.numStages;
+		
+		string source = "uniform sampler2D tex;\nuniform vec2 texel;\n";
+		for(int j=0; j<pass.numStages; j++) source += "uniform vec4 p" + ofToString(j) + ";\n";
+		source += "void main() {\n"
+			"vec2 coord = gl_TexCoord[0].st;\n"
+			"vec4 color;\n";
+		if(!stages[pass.firstStage].sampling) source += "color = texture2D(tex, coord);\n";
+		for(int j=0; j<pass.numStages; j++) {
+			source += "{\nvec4 param = p" + ofToString(j) + ";\n" + stages[pass.firstStage + j].glsl + "}\n";
+		}
+		source += "gl_FragColor = color * gl_Color;\n}\n";
+		
+		pass.program = getProgram(source);
+		if(pass.program == COGL_INVALID_HANDLE) {
+			releasePasses();
+			return;
+		}
+		pass.texLocation = cogl_program_get_uniform_location(pass.program, "tex");
+		pass.texelLocation = cogl_program_get_uniform_location(pass.program, "texel");
+		for(int j=0; j<pass.numStages; j++) {
+			pass.paramLocations.push_back(cogl_program_get_uniform_location(pass.program, ("p" + ofToString(j)).c_str()));
+		}
+		pass.material = cogl_material_new();
+		cogl_material_set_user_program(pass.material, pass.program);
+		passes.push_back(pass);
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterEffectChain::releasePasses() {
+	for(int i=0; i<passes.size(); i++) cogl_handle_unref(passes[i].material);
+	passes.clear();
+}
+
+
+//------------------------------------------------------------
+// Chains with the same sequence of stage code share their programs
+CoglHandle ofxClutterEffectChain::getProgram(const string& source) {
+	static map<string, CoglHandle> programs;
+	map<string, CoglHandle>::iterator it = programs.find(source);
+	if(it != programs.end()) return it->second;
+	
+	CoglHandle shader = cogl_create_shader(COGL_SHADER_TYPE_FRAGMENT);
+	cogl_shader_source(shader, source.c_str());
+	cogl_shader_compile(shader);
+	if(!cogl_shader_is_compiled(shader)) {
+		char* log = cogl_shader_get_info_log(shader);
+		ofLog(OF_LOG_ERROR, "ofxClutterEffectChain: shader didn't compile.");
+		fprintf (stderr, "%s\n", log);
+		g_free(log);
+		cogl_handle_unref(shader);
+		return COGL_INVALID_HANDLE;
+	}
+	
+	CoglHandle program = cogl_create_program();
+	cogl_program_attach_shader(program, shader);
+	cogl_program_link(program);
+	cogl_handle_unref(shader);
+	programs[source] = program;
+	return program;
+}
+
+
+//------------------------------------------------------------
+// Uniforms belong to the shared programs, so they are set right before each draw
+void ofxClutterEffectChain::setUniforms(Pass& pass, int w, int h) {
+	if(pass.texLocation >= 0) cogl_program_set_uniform_1i(pass.program, pass.texLocation, 0);
+	if(pass.texelLocation >= 0) {
+		float texel[2] = {1.0f / w, 1.0f / h};
+		cogl_program_set_uniform_float(pass.program, pass.texelLocation, 2, 1, texel);
+	}
+	for(int j=0; j<pass.numStages; j++) {
+		if(pass.paramLocations[j] < 0) continue;
+		cogl_program_set_uniform_float(pass.program, pass.paramLocations[j], 4, 1, stages[pass.firstStage + j].params);
+	}
+}
+
+
+//------------------------------------------------------------
+// Each pass renders into a pooled target and the last one is the result
+CoglHandle ofxClutterEffectChain::process(CoglHandle source, int w, int h) {
+	if(passesDirty) buildPasses();
+	
+	CoglHandle current = source;
+	for(int i=0; i<passes.size(); i++) {
+		CoglHandle dest = ofxClutterOffscreenPool::acquire(w, h);
+		if(dest == COGL_INVALID_HANDLE) break;
+		
+		cogl_material_set_layer(passes[i].material, 0, current);
+		setUniforms(passes[i], w, h);
+		drawInto(dest, passes[i].material);
+		
+		if(current != source) ofxClutterOffscreenPool::releaseAfterFrame(current);
+		current = dest;
+	}
+	return current;
+}
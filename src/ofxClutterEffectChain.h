@@ -0,0 +1,70 @@
+/*
+ *  ofxClutterEffectChain.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterCachedEffect.h"
+
+
+// A list of image effects applied to one actor through a single offscreen
+// effect.  The actor is rendered once into a pooled texture; consecutive
+// per-pixel stages (desaturate, colorize, brightness/contrast, your own
+// color code) are merged into one shader pass, and only stages that sample
+// neighbouring pixels (blur) start a new pass, with intermediate targets
+// also taken from ofxClutterOffscreenPool.
+//
+// The effect object survives remove(), so toggling it on hover doesn't
+// rebuild programs or allocate render targets, and the result is cached
+// until the actor or a parameter changes.
+class ofxClutterEffectChain : public ofxClutterCachedEffect {
+public:
+	ofxClutterEffectChain();
+	~ofxClutterEffectChain();
+	
+	// Each returns the stage index for setParams()
+	int addDesaturate(float factor=1);
+	int addColorize(int r, int g, int b);
+	int addBrightnessContrast(float brightness, float contrast);
+	int addBoxBlur(float radius=1);
+	
+	// GLSL that modifies the premultiplied "vec4 color", with "vec4 param"
+	// holding the stage's parameters
+	int addColorStage(string glsl);
+	// GLSL that sets "color" by sampling "tex" around "vec2 coord";
+	// "vec2 texel" is the size of one source pixel
+	int addSampleStage(string glsl);
+	
+	void setParams(int stage, float x, float y=0, float z=0, float w=0);
+	void clear();
+	
+	int getNumStages() { return stages.size(); }
+	int getNumPasses();
+	
+protected:
+	struct Stage {
+		bool sampling;
+		string glsl;
+		float params[4];
+	};
+	
+	struct Pass {
+		int firstStage, numStages;
+		CoglHandle program;
+		CoglMaterial* material;
+		int texLocation, texelLocation;
+		vector<int> paramLocations;
+	};
+	
+	CoglHandle process(CoglHandle source, int w, int h);
+	int addStage(bool sampling, string glsl, float x, float y, float z, float w);
+	void buildPasses();
+	void releasePasses();
+	void setUniforms(Pass& pass, int w, int h);
+	static CoglHandle getProgram(const string& source);
+	
+	vector<Stage> stages;
+	vector<Pass> passes;
+	bool passesDirty;
+};
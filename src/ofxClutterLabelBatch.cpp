@@ -0,0 +1,401 @@
+/*
+ *  ofxClutterLabelBatch.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterLabelBatch.h"
+#include <cogl/cogl-pango.h>
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+static const int atlasSize = 1024;
+static const int padding = 1;
+
+// 16 bit quad indices from Cogl limit a vertex buffer to 65536 vertices
+static const int maxQuadsPerBuffer = 65536 / 4;
+
+struct ofxClutterLabelVertex {
+	float x, y;
+	float s, t;
+	guint8 r, g, b, a;
+};
+
+
+//------------------------------------------------------------
+ofxClutterLabelBatch::ofxClutterLabelBatch(string font) {
+	actor = clutter_group_new();
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	g_signal_connect_after(actor, "paint", G_CALLBACK(onPaint), this);
+	
+	fontDesc = pango_font_description_from_string(font.c_str());
+	dirty = false;
+	lastOpacity = 0;
+	numDrawCalls = numRebuilds = numCompactions = 0;
+	usedArea = unusedArea = numUnusedStrings = 0;
+}
+
+
+//------------------------------------------------------------
+ofxClutterLabelBatch::~ofxClutterLabelBatch() {
+	clutter_actor_destroy(actor);
+	clear();
+	pango_font_description_free(fontDesc);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::clear() {
+	for(int i=0; i<strings.size(); i++) {
+		g_object_unref(strings[i].layout);
+	}
+	for(int i=0; i<pages.size(); i++) {
+		for(int j=0; j<pages[i].buffers.size(); j++) cogl_handle_unref(pages[i].buffers[j]);
+		cogl_handle_unref(pages[i].material);
+		cogl_handle_unref(pages[i].texture);
+	}
+	stringIds.clear();
+	strings.clear();
+	pendingStrings.clear();
+	pages.clear();
+	labelStrings.clear();
+	positions.clear();
+	colors.clear();
+	usedArea = unusedArea = numUnusedStrings = 0;
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+// Shapes a string the first time it's seen; later labels with the same
+// text share the layout and the atlas rect.  The new string has no refs
+// yet, so it starts out unused.
+int ofxClutterLabelBatch::internString(string text) {
+	map<string, int>::iterator it = stringIds.find(text);
+	if(it != stringIds.end()) return it->second;
+	
+	String s;
+	s.layout = pango_layout_new(clutter_actor_get_pango_context(actor));
+	pango_layout_set_font_description(s.layout, fontDesc);
+	pango_layout_set_text(s.layout, text.c_str(), text.size());
+	s.refs = 0;
+	s.page = -1;
+	s.x = s.y = s.w = s.h = 0;
+	s.offsetX = s.offsetY = 0;
+	
+	int id = strings.size();
+	strings.push_back(s);
+	stringIds[text] = id;
+	pendingStrings.push_back(id);
+	numUnusedStrings++;
+	return id;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::retainString(int id) {
+	String& s = strings[id];
+	if(s.refs++ > 0) return;
+	numUnusedStrings--;
+	if(s.page >= 0) {
+		usedArea += s.w * s.h;
+		unusedArea -= s.w * s.h;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::releaseString(int id) {
+	String& s = strings[id];
+	if(--s.refs > 0) return;
+	numUnusedStrings++;
+	if(s.page >= 0) {
+		usedArea -= s.w * s.h;
+		unusedArea += s.w * s.h;
+	}
+}
+
+
+//------------------------------------------------------------
+// Drops the unused strings and the atlas pages, and queues the rest to be
+// rendered again, packed from scratch.
+void ofxClutterLabelBatch::compact() {
+	vector<int> newIds(strings.size(), -1);
+	vector<String> kept;
+	stringIds.clear();
+	for(int i=0; i<strings.size(); i++) {
+		String s = strings[i];
+		if(s.refs == 0) {
+			g_object_unref(s.layout);
+			continue;
+		}
+		s.page = -1;
+		newIds[i] = kept.size();
+		stringIds[pango_layout_get_text(s.layout)] = kept.size();
+		kept.push_back(s);
+	}
+	strings.swap(kept);
+	for(int i=0; i<labelStrings.size(); i++) {
+		labelStrings[i] = newIds[labelStrings[i]];
+	}
+	
+	for(int i=0; i<pages.size(); i++) {
+		for(int j=0; j<pages[i].buffers.size(); j++) cogl_handle_unref(pages[i].buffers[j]);
+		cogl_handle_unref(pages[i].material);
+		cogl_handle_unref(pages[i].texture);
+	}
+	pages.clear();
+	pendingStrings.clear();
+	for(int i=0; i<strings.size(); i++) pendingStrings.push_back(i);
+	
+	usedArea = unusedArea = numUnusedStrings = 0;
+	dirty = true;
+	numCompactions++;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterLabelBatch::addLabel(string text, float x, float y, int r, int g, int b, int opacity) {
+	int id = internString(text);
+	retainString(id);
+	labelStrings.push_back(id);
+	positions.push_back(x);
+	positions.push_back(y);
+	colors.push_back(r);
+	colors.push_back(g);
+	colors.push_back(b);
+	colors.push_back(opacity);
+	setDirty();
+	return labelStrings.size() - 1;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::setLabelText(int i, string text) {
+	int id = internString(text);
+	if(labelStrings[i] == id) return;
+	retainString(id);
+	releaseString(labelStrings[i]);
+	labelStrings[i] = id;
+	setDirty();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::setLabelPosition(int i, float x, float y) {
+	positions[i*2] = x;
+	positions[i*2+1] = y;
+	setDirty();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::setLabelColor(int i, int r, int g, int b) {
+	colors[i*4] = r;
+	colors[i*4+1] = g;
+	colors[i*4+2] = b;
+	setDirty();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::setLabelOpacity(int i, int opacity) {
+	colors[i*4+3] = opacity;
+	setDirty();
+}
+
+
+//------------------------------------------------------------
+// Shelf packing: strings go left to right along a shelf, and a new shelf
+// starts below the tallest string of the last one.
+bool ofxClutterLabelBatch::placeString(String& s) {
+	PangoRectangle ink, logical;
+	pango_layout_get_pixel_extents(s.layout, &ink, &logical);
+	int x1 = MIN(ink.x, logical.x);
+	int y1 = MIN(ink.y, logical.y);
+	int x2 = MAX(ink.x + ink.width, logical.x + logical.width);
+	int y2 = MAX(ink.y + ink.height, logical.y + logical.height);
+	s.w = x2 - x1 + padding*2;
+	s.h = y2 - y1 + padding*2;
+	s.offsetX = x1 - padding;
+	s.offsetY = y1 - padding;
+	if(s.w > atlasSize || s.h > atlasSize) return false;
+	
+	for(int attempt=0; attempt<2; attempt++) {
+		if(!pages.empty()) {
+			Page& p = pages.back();
+			if(p.shelfX + s.w > atlasSize) {
+				p.shelfY += p.shelfHeight;
+				p.shelfX = 0;
+				p.shelfHeight = 0;
+			}
+			if(p.shelfY + s.h <= atlasSize) {
+				s.page = pages.size() - 1;
+				s.x = p.shelfX;
+				s.y = p.shelfY;
+				p.shelfX += s.w;
+				p.shelfHeight = MAX(p.shelfHeight, s.h);
+				return true;
+			}
+		}
+		
+		// Full (or none yet): start a new page
+		Page p;
+		p.texture = cogl_texture_new_with_size(atlasSize, atlasSize,
+											   (CoglTextureFlags)(COGL_TEXTURE_NO_SLICING | COGL_TEXTURE_NO_ATLAS | COGL_TEXTURE_NO_AUTO_MIPMAP),
+											   COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+		p.material = cogl_material_new();
+		cogl_material_set_layer(p.material, 0, p.texture);
+		p.shelfX = p.shelfY = p.shelfHeight = 0;
+		
+		CoglHandle fb = cogl_offscreen_new_to_texture(p.texture);
+		CoglColor transparent;
+		cogl_color_set_from_4ub(&transparent, 0, 0, 0, 0);
+		cogl_push_framebuffer((CoglFramebuffer*)fb);
+		cogl_clear(&transparent, COGL_BUFFER_BIT_COLOR);
+		cogl_pop_framebuffer();
+		cogl_handle_unref(fb);
+		
+		pages.push_back(p);
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+// Renders new strings into the atlas in white; the vertex colors tint them.
+void ofxClutterLabelBatch::renderStrings() {
+	if(pendingStrings.empty()) return;
+	
+	CoglColor white;
+	cogl_color_set_from_4ub(&white, 255, 255, 255, 255);
+	
+	int page = -1;
+	CoglHandle fb = COGL_INVALID_HANDLE;
+	for(int i=0; i<pendingStrings.size(); i++) {
+		String& s = strings[pendingStrings[i]];
+		if(!placeString(s)) {
+			ofLog(OF_LOG_WARNING, "ofxClutterLabelBatch: label too big for the atlas: " + string(pango_layout_get_text(s.layout)));
+			continue;
+		}
+		if(s.refs > 0) usedArea += s.w * s.h;
+		else unusedArea += s.w * s.h;
+		
+		if(s.page != page) {
+			if(fb != COGL_INVALID_HANDLE) {
+				cogl_pop_framebuffer();
+				cogl_handle_unref(fb);
+			}
+			page = s.page;
+			fb = cogl_offscreen_new_to_texture(pages[page].texture);
+			cogl_push_framebuffer((CoglFramebuffer*)fb);
+			cogl_set_viewport(0, 0, atlasSize, atlasSize);
+			cogl_ortho(0, atlasSize, atlasSize, 0, -1, 1);
+		}
+		cogl_pango_render_layout(s.layout, s.x - s.offsetX, s.y - s.offsetY, &white, 0);
+	}
+	if(fb != COGL_INVALID_HANDLE) {
+		cogl_pop_framebuffer();
+		cogl_handle_unref(fb);
+	}
+	pendingStrings.clear();
+}
+
+
+//------------------------------------------------------------
+// Builds one quad per visible label.  The paint opacity is folded into the
+// vertex colors (premultiplied), so it triggers a rebuild when it changes.
+void ofxClutterLabelBatch::rebuild(guint8 opacity) {
+	vector< vector<ofxClutterLabelVertex> > vertices(pages.size());
+	for(int i=0; i<labelStrings.size(); i++) {
+		String& s = strings[labelStrings[i]];
+		int a = colors[i*4+3] * opacity / 255;
+		if(s.page < 0 || a == 0) continue;
+		
+		float x1 = positions[i*2] + s.offsetX;
+		float y1 = positions[i*2+1] + s.offsetY;
+		float x2 = x1 + s.w;
+		float y2 = y1 + s.h;
+		float s1 = (float)s.x / atlasSize;
+		float t1 = (float)s.y / atlasSize;
+		float s2 = (float)(s.x + s.w) / atlasSize;
+		float t2 = (float)(s.y + s.h) / atlasSize;
+		
+		ofxClutterLabelVertex v;
+		v.r = colors[i*4] * a / 255;
+		v.g = colors[i*4+1] * a / 255;
+		v.b = colors[i*4+2] * a / 255;
+		v.a = a;
+		vector<ofxClutterLabelVertex>& out = vertices[s.page];
+		v.x = x1; v.y = y1; v.s = s1; v.t = t1; out.push_back(v);
+		v.x = x1; v.y = y2; v.s = s1; v.t = t2; out.push_back(v);
+		v.x = x2; v.y = y2; v.s = s2; v.t = t2; out.push_back(v);
+		v.x = x2; v.y = y1; v.s = s2; v.t = t1; out.push_back(v);
+	}
+	
+	for(int p=0; p<pages.size(); p++) {
+		Page& page = pages[p];
+		for(int j=0; j<page.buffers.size(); j++) cogl_handle_unref(page.buffers[j]);
+		page.buffers.clear();
+		page.numQuads.clear();
+		
+		int total = vertices[p].size() / 4;
+		for(int first=0; first<total; first+=maxQuadsPerBuffer) {
+			int n = MIN(maxQuadsPerBuffer, total - first);
+			ofxClutterLabelVertex* v = &vertices[p][first*4];
+			CoglHandle buffer = cogl_vertex_buffer_new(n*4);
+			cogl_vertex_buffer_add(buffer, "gl_Vertex", 2, COGL_ATTRIBUTE_TYPE_FLOAT, FALSE,
+								   sizeof(ofxClutterLabelVertex), &v->x);
+			cogl_vertex_buffer_add(buffer, "gl_MultiTexCoord0", 2, COGL_ATTRIBUTE_TYPE_FLOAT, FALSE,
+								   sizeof(ofxClutterLabelVertex), &v->s);
+			cogl_vertex_buffer_add(buffer, "gl_Color", 4, COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE, TRUE,
+								   sizeof(ofxClutterLabelVertex), &v->r);
+			cogl_vertex_buffer_submit(buffer);
+			page.buffers.push_back(buffer);
+			page.numQuads.push_back(n);
+		}
+	}
+	
+	dirty = false;
+	lastOpacity = opacity;
+	numRebuilds++;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::paint() {
+	numDrawCalls = 0;
+	if(labelStrings.empty()) return;
+	
+	if(unusedArea > usedArea && unusedArea > atlasSize * atlasSize / 4) {
+		compact();
+	}
+	renderStrings();
+	
+	guint8 opacity = clutter_actor_get_paint_opacity(actor);
+	if(dirty || opacity != lastOpacity) {
+		rebuild(opacity);
+	}
+	
+	for(int p=0; p<pages.size(); p++) {
+		if(pages[p].buffers.empty()) continue;
+		cogl_set_source(pages[p].material);
+		for(int j=0; j<pages[p].buffers.size(); j++) {
+			int n = pages[p].numQuads[j];
+			CoglHandle indices = cogl_vertex_buffer_indices_get_for_quads(n*6);
+			cogl_vertex_buffer_draw_elements(pages[p].buffers[j], COGL_VERTICES_MODE_TRIANGLES, indices,
+											 0, n*4 - 1, 0, n*6);
+			numDrawCalls++;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLabelBatch::onPaint(ClutterActor* actor, gpointer data) {
+	((ofxClutterLabelBatch*)data)->paint();
+}
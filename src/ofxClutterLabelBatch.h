@@ -0,0 +1,99 @@
+/*
+ *  ofxClutterLabelBatch.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+
+
+// Draws thousands of short text labels (axis ticks, map names) as one
+// actor.  Each distinct string is shaped once with Pango and rendered once,
+// from the Cogl glyph cache, into a shared atlas texture.  Every label is
+// then a quad into that atlas, and all the quads go out in one vertex
+// buffer per atlas page, tinted by per-vertex colors.
+//
+// All labels share one font.  Positions, colors and opacities live in flat
+// arrays that can be edited in bulk; call setDirty() after writing to them
+// directly.
+//
+// Strings no label shows any more stay in the atlas, in case they come
+// back (counters, clocks), until they take up more of it than the strings
+// in use and at least a quarter of a page.  Then the atlas is rebuilt with
+// only the strings in use.
+class ofxClutterLabelBatch : public ofxClutterActor {
+public:
+	ofxClutterLabelBatch(string font="Sans 10");
+	~ofxClutterLabelBatch();
+	
+	// Returns the label's index
+	int addLabel(string text, float x, float y, int r=0, int g=0, int b=0, int opacity=255);
+	void clear();
+	int getNumLabels() { return labelStrings.size(); }
+	
+	void setLabelText(int i, string text);
+	void setLabelPosition(int i, float x, float y);
+	void setLabelColor(int i, int r, int g, int b);
+	void setLabelOpacity(int i, int opacity);
+	
+	// x,y per label, and r,g,b,opacity per label
+	float* getPositions() { return positions.empty() ? NULL : &positions[0]; }
+	unsigned char* getColors() { return colors.empty() ? NULL : &colors[0]; }
+	void setDirty() { dirty = true; clutter_actor_queue_redraw(actor); }
+	
+	int getNumStrings() { return strings.size(); }
+	int getNumUnusedStrings() { return numUnusedStrings; }
+	int getNumAtlasPages() { return pages.size(); }
+	int getNumDrawCalls() { return numDrawCalls; }
+	int getNumRebuilds() { return numRebuilds; }
+	int getNumCompactions() { return numCompactions; }
+	
+protected:
+	// A shaped string and where it was rendered in the atlas
+	struct String {
+		PangoLayout* layout;
+		int refs;				// labels showing it
+		int page;				// -1 until rendered
+		int x, y, w, h;			// atlas rect, including padding
+		int offsetX, offsetY;	// label origin to atlas rect origin
+	};
+	
+	struct Page {
+		CoglHandle texture;
+		CoglMaterial* material;
+		vector<CoglHandle> buffers;	// at most maxQuadsPerBuffer quads each
+		vector<int> numQuads;
+		int shelfX, shelfY, shelfHeight;
+	};
+	
+	int internString(string text);
+	void retainString(int id);
+	void releaseString(int id);
+	void compact();
+	void renderStrings();
+	bool placeString(String& s);
+	void rebuild(guint8 opacity);
+	void paint();
+	static void onPaint(ClutterActor* actor, gpointer data);
+	
+	PangoFontDescription* fontDesc;
+	
+	map<string, int> stringIds;
+	vector<String> strings;
+	vector<int> pendingStrings;
+	vector<Page> pages;
+	int usedArea;			// atlas pixels of strings in use
+	int unusedArea;			// and of strings that aren't
+	int numUnusedStrings;
+	
+	vector<int> labelStrings;
+	vector<float> positions;
+	vector<unsigned char> colors;
+	
+	bool dirty;
+	guint8 lastOpacity;
+	int numDrawCalls;
+	int numRebuilds;
+	int numCompactions;
+};
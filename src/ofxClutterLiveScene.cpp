@@ -0,0 +1,403 @@
+/*
+ *  ofxClutterLiveScene.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterLiveScene.h"
+#include <sys/stat.h>
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+//------------------------------------------------------------
+ofxClutterLiveScene::ofxClutterLiveScene() {
+	script = NULL;
+	parser = NULL;
+	pollSource = 0;
+	lastMTime = 0;
+	lastSize = 0;
+	numPropertiesChanged = numCreated = numDestroyed = numMoved = 0;
+	reloadMillis = 0;
+}
+
+
+//------------------------------------------------------------
+ofxClutterLiveScene::~ofxClutterLiveScene() {
+	clear();
+}
+
+
+//------------------------------------------------------------
+static string serialize(JsonNode* node) {
+	JsonGenerator* generator = json_generator_new();
+	json_generator_set_root(generator, node);
+	gchar* data = json_generator_to_data(generator, NULL);
+	string str = data ? data : "";
+	g_free(data);
+	g_object_unref(generator);
+	return str;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterLiveScene::load(string jsonPath) {
+	clear();
+	path = ofToDataPath(jsonPath);
+	
+	gchar* data;
+	gsize length;
+	struct stat st;
+	if(stat(path.c_str(), &st) != 0 || !g_file_get_contents(path.c_str(), &data, &length, NULL)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterLiveScene: couldn't read " + path);
+		return false;
+	}
+	lastMTime = st.st_mtime;
+	lastSize = st.st_size;
+	
+	script = clutter_script_new();
+	GError* error = NULL;
+	if(clutter_script_load_from_data(script, data, length, &error) == 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterLiveScene: couldn't load " + path);
+		fprintf(stderr, "%s\n", error->message);
+		g_error_free(error);
+		g_object_unref(script);
+		script = NULL;
+		g_free(data);
+		return false;
+	}
+	parse(data, length, parser, current, roots);
+	g_free(data);
+	
+	for(Snapshot::iterator it = current.begin(); it != current.end(); it++) {
+		GObject* object = clutter_script_get_object(script, it->first.c_str());
+		if(object && CLUTTER_IS_ACTOR(object)) {
+			actors[it->first] = CLUTTER_ACTOR(g_object_ref(object));
+		}
+	}
+	
+	// ClutterScript leaves the top of the tree unparented
+	GList* objects = clutter_script_list_objects(script);
+	for(GList* o = objects; o; o = o->next) {
+		if(!CLUTTER_IS_ACTOR(o->data) || CLUTTER_IS_STAGE(o->data)) continue;
+		ClutterActor* actor = CLUTTER_ACTOR(o->data);
+		if(clutter_actor_get_parent(actor) != NULL) continue;
+		clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+		clutter_actor_show(actor);
+		
+		bool tracked = false;
+		for(map<string, ClutterActor*>::iterator it = actors.begin(); it != actors.end(); it++) {
+			if(it->second == actor) tracked = true;
+		}
+		if(!tracked) anonymousRoots.push_back(CLUTTER_ACTOR(g_object_ref(actor)));
+	}
+	g_list_free(objects);
+	restack(roots);
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLiveScene::clear() {
+	watch(false);
+	
+	// Destroying a parent takes its children with it, which unparents them
+	for(map<string, ClutterActor*>::iterator it = actors.begin(); it != actors.end(); it++) {
+		if(clutter_actor_get_parent(it->second)) clutter_actor_destroy(it->second);
+		g_object_unref(it->second);
+	}
+	for(int i=0; i<anonymousRoots.size(); i++) {
+		if(clutter_actor_get_parent(anonymousRoots[i])) clutter_actor_destroy(anonymousRoots[i]);
+		g_object_unref(anonymousRoots[i]);
+	}
+	actors.clear();
+	anonymousRoots.clear();
+	current.clear();
+	roots.clear();
+	
+	if(parser) g_object_unref(parser);
+	parser = NULL;
+	if(script) g_object_unref(script);
+	script = NULL;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLiveScene::watch(bool enabled, int intervalMillis) {
+	if(pollSource) g_source_remove(pollSource);
+	pollSource = 0;
+	if(enabled) pollSource = clutter_threads_add_timeout(intervalMillis, onPoll, this);
+}
+
+
+//------------------------------------------------------------
+// Polling the modification time works with every editor, including the
+// ones that save by writing a new file and renaming it over the old one
+gboolean ofxClutterLiveScene::onPoll(gpointer data) {
+	ofxClutterLiveScene* scene = (ofxClutterLiveScene*)data;
+	struct stat st;
+	if(stat(scene->path.c_str(), &st) == 0 && (st.st_mtime != scene->lastMTime || st.st_size != scene->lastSize)) {
+		scene->lastMTime = st.st_mtime;
+		scene->lastSize = st.st_size;
+		scene->reload();
+	}
+	return TRUE;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLiveScene::collect(JsonObject* object, const string& parent, bool untrackedParent, Snapshot& snapshot,
+								  vector<string>& topLevel, vector<pair<string, string> >& references) {
+	const char* id = json_object_has_member(object, "id") ? json_object_get_string_member(object, "id") : NULL;
+	const char* type = json_object_has_member(object, "type") ? json_object_get_string_member(object, "type") : NULL;
+	if(type == NULL) return;
+	GType gtype = ofxClutterScene::resolveType(type);
+	if(gtype == 0 || !g_type_is_a(gtype, CLUTTER_TYPE_ACTOR) || ofxClutterScene::findType(type) == OFX_CLUTTER_SCENE_STAGE) return;
+	
+	bool tracked = (id != NULL && id[0] != '\0');
+	if(tracked && snapshot.count(id)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterLiveScene: id " + string(id) + " is used more than once, ignoring the second");
+		tracked = false;
+	}
+	if(tracked) {
+		Object& o = snapshot[id];
+		o.type = type;
+		o.parent = parent;
+		o.untrackedParent = untrackedParent;
+		GList* members = json_object_get_members(object);
+		for(GList* m = members; m; m = m->next) {
+			const char* name = (const char*)m->data;
+			if(strcmp(name, "id") == 0 || strcmp(name, "type") == 0 || strcmp(name, "children") == 0) continue;
+			o.properties[name] = json_object_get_member(object, name);
+		}
+		g_list_free(members);
+		if(parent.empty() && !untrackedParent) topLevel.push_back(id);
+	}
+	
+	if(!json_object_has_member(object, "children")) return;
+	JsonNode* children = json_object_get_member(object, "children");
+	if(JSON_NODE_TYPE(children) != JSON_NODE_ARRAY) return;
+	JsonArray* array = json_node_get_array(children);
+	for(int i=0; i<json_array_get_length(array); i++) {
+		JsonNode* child = json_array_get_element(array, i);
+		if(JSON_NODE_TYPE(child) == JSON_NODE_OBJECT) {
+			JsonObject* c = json_node_get_object(child);
+			if(tracked && json_object_has_member(c, "id")) {
+				snapshot[id].children.push_back(json_object_get_string_member(c, "id"));
+			}
+			collect(c, tracked ? id : "", !tracked, snapshot, topLevel, references);
+		}
+		else if(tracked && JSON_NODE_TYPE(child) == JSON_NODE_VALUE && json_node_get_value_type(child) == G_TYPE_STRING) {
+			snapshot[id].children.push_back(json_node_get_string(child));
+			references.push_back(make_pair(string(id), string(json_node_get_string(child))));
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterLiveScene::parse(const gchar* data, gsize length, JsonParser*& result, Snapshot& snapshot, vector<string>& roots) {
+	result = json_parser_new();
+	GError* error = NULL;
+	if(!json_parser_load_from_data(result, data, length, &error)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterLiveScene: couldn't parse " + path + ", keeping the current scene");
+		fprintf(stderr, "%s\n", error->message);
+		g_error_free(error);
+		g_object_unref(result);
+		result = NULL;
+		return false;
+	}
+	
+	// A ClutterScript file is one object or an array of them
+	vector<string> topLevel;
+	vector<pair<string, string> > references;
+	JsonNode* root = json_parser_get_root(result);
+	if(JSON_NODE_TYPE(root) == JSON_NODE_OBJECT) {
+		collect(json_node_get_object(root), "", false, snapshot, topLevel, references);
+	}
+	else if(JSON_NODE_TYPE(root) == JSON_NODE_ARRAY) {
+		JsonArray* array = json_node_get_array(root);
+		for(int i=0; i<json_array_get_length(array); i++) {
+			JsonNode* element = json_array_get_element(array, i);
+			if(JSON_NODE_TYPE(element) == JSON_NODE_OBJECT) {
+				collect(json_node_get_object(element), "", false, snapshot, topLevel, references);
+			}
+		}
+	}
+	
+	// Children given by id are top-level objects that belong under their parent
+	for(int i=0; i<references.size(); i++) {
+		Snapshot::iterator child = snapshot.find(references[i].second);
+		if(child == snapshot.end() || !child->second.parent.empty() || child->second.untrackedParent
+		   || child->first == references[i].first) continue;
+		child->second.parent = references[i].first;
+	}
+	for(Snapshot::iterator it = snapshot.begin(); it != snapshot.end(); it++) {
+		vector<string>& children = it->second.children;
+		for(int i=children.size()-1; i>=0; i--) {
+			Snapshot::iterator child = snapshot.find(children[i]);
+			if(child == snapshot.end() || child->second.parent != it->first) children.erase(children.begin() + i);
+		}
+	}
+	
+	roots.clear();
+	for(int i=0; i<topLevel.size(); i++) {
+		if(snapshot[topLevel[i]].parent.empty()) roots.push_back(topLevel[i]);
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterLiveScene::reload() {
+	if(script == NULL) return false;
+	GTimer* timer = g_timer_new();
+	
+	gchar* data;
+	gsize length;
+	if(!g_file_get_contents(path.c_str(), &data, &length, NULL)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterLiveScene: couldn't read " + path);
+		g_timer_destroy(timer);
+		return false;
+	}
+	JsonParser* nextParser = NULL;
+	Snapshot next;
+	vector<string> nextRoots;
+	bool parsed = parse(data, length, nextParser, next, nextRoots);
+	g_free(data);
+	if(!parsed) {
+		g_timer_destroy(timer);
+		return false;
+	}
+	
+	numPropertiesChanged = numCreated = numDestroyed = numMoved = 0;
+	
+	// Gone, or changed type and so rebuilt
+	vector<ClutterActor*> doomed;
+	for(Snapshot::iterator it = current.begin(); it != current.end(); it++) {
+		Snapshot::iterator n = next.find(it->first);
+		if(n != next.end() && n->second.type == it->second.type) continue;
+		map<string, ClutterActor*>::iterator a = actors.find(it->first);
+		if(a == actors.end()) continue;
+		doomed.push_back(a->second);
+		actors.erase(a);
+	}
+	
+	// New
+	set<string> created;
+	for(Snapshot::iterator it = next.begin(); it != next.end(); it++) {
+		if(actors.count(it->first)) continue;
+		if(it->second.untrackedParent) {
+			ofLog(OF_LOG_WARNING, "ofxClutterLiveScene: can't add " + it->first + " under an object without an id");
+			continue;
+		}
+		const char* type = it->second.type.c_str();
+		ClutterActor* actor = ofxClutterScene::createActor(ofxClutterScene::findType(type), type);
+		if(actor == NULL) continue;
+		actors[it->first] = CLUTTER_ACTOR(g_object_ref_sink(actor));
+		created.insert(it->first);
+		numCreated++;
+	}
+	
+	// Parents, before the old ones are destroyed
+	for(Snapshot::iterator it = next.begin(); it != next.end(); it++) {
+		map<string, ClutterActor*>::iterator a = actors.find(it->first);
+		if(a == actors.end() || it->second.untrackedParent) continue;
+		ClutterActor* parent = stage;
+		if(!it->second.parent.empty()) {
+			map<string, ClutterActor*>::iterator p = actors.find(it->second.parent);
+			if(p == actors.end()) continue;
+			parent = p->second;
+		}
+		if(!CLUTTER_IS_CONTAINER(parent)) {
+			ofLog(OF_LOG_ERROR, "ofxClutterLiveScene: " + it->second.parent + " can't have children");
+			continue;
+		}
+		ClutterActor* oldParent = clutter_actor_get_parent(a->second);
+		if(oldParent == parent) continue;
+		if(oldParent) {
+			clutter_actor_reparent(a->second, parent);
+			numMoved++;
+		}
+		else {
+			clutter_container_add_actor(CLUTTER_CONTAINER(parent), a->second);
+			clutter_actor_show(a->second);
+		}
+	}
+	
+	// Properties and stacking order
+	for(Snapshot::iterator it = next.begin(); it != next.end(); it++) {
+		map<string, ClutterActor*>::iterator a = actors.find(it->first);
+		if(a == actors.end()) continue;
+		bool isNew = created.count(it->first) > 0;
+		Snapshot::iterator previous = current.find(it->first);
+		applyProperties(a->second, it->first, it->second, isNew ? NULL : &previous->second);
+		if(isNew || previous->second.children != it->second.children) restack(it->second.children);
+	}
+	if(nextRoots != roots) restack(nextRoots);
+	
+	for(int i=0; i<doomed.size(); i++) {
+		if(clutter_actor_get_parent(doomed[i])) clutter_actor_destroy(doomed[i]);
+		g_object_unref(doomed[i]);
+		numDestroyed++;
+	}
+	
+	if(parser) g_object_unref(parser);
+	parser = nextParser;
+	current.swap(next);
+	roots.swap(nextRoots);
+	
+	reloadMillis = g_timer_elapsed(timer, NULL) * 1000;
+	g_timer_destroy(timer);
+	ofLog(OF_LOG_NOTICE, "ofxClutterLiveScene: reloaded " + path + " in " + ofToString(reloadMillis, 1) + " ms, "
+		  + ofToString(numPropertiesChanged) + " properties, " + ofToString(numCreated) + " created, "
+		  + ofToString(numDestroyed) + " destroyed, " + ofToString(numMoved) + " moved");
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLiveScene::applyProperties(ClutterActor* actor, const string& id, const Object& object, const Object* previous) {
+	for(map<string, JsonNode*>::const_iterator it = object.properties.begin(); it != object.properties.end(); it++) {
+		if(previous) {
+			map<string, JsonNode*>::const_iterator old = previous->properties.find(it->first);
+			if(old != previous->properties.end() && serialize(old->second) == serialize(it->second)) continue;
+		}
+		ofxClutterSceneProperty property = ofxClutterScene::findProperty(it->first.c_str());
+		GValue value = { 0 };
+		if(!ofxClutterScene::readValue(it->second, property, &value)) {
+			ofLog(OF_LOG_WARNING, "ofxClutterLiveScene: can't reload " + it->first + " of " + id + ", it isn't a plain value");
+			continue;
+		}
+		ofxClutterScene::setProperty(actor, property, it->first.c_str(), &value);
+		g_value_unset(&value);
+		numPropertiesChanged++;
+	}
+	
+	if(previous == NULL) return;
+	for(map<string, JsonNode*>::const_iterator it = previous->properties.begin(); it != previous->properties.end(); it++) {
+		if(object.properties.count(it->first) == 0) {
+			ofxClutterScene::resetProperty(actor, ofxClutterScene::findProperty(it->first.c_str()), it->first.c_str());
+			numPropertiesChanged++;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLiveScene::restack(const vector<string>& ids) {
+	for(int i=0; i<ids.size(); i++) {
+		map<string, ClutterActor*>::iterator a = actors.find(ids[i]);
+		if(a != actors.end() && clutter_actor_get_parent(a->second)) clutter_actor_raise_top(a->second);
+	}
+}
+
+
+//------------------------------------------------------------
+ClutterActor* ofxClutterLiveScene::get(string id) {
+	map<string, ClutterActor*>::iterator a = actors.find(id);
+	return (a == actors.end()) ? NULL : a->second;
+}
@@ -0,0 +1,76 @@
+/*
+ *  ofxClutterLiveScene.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterScene.h"
+
+
+// A ClutterScript JSON scene that follows edits to its file.  The first
+// load goes through clutter_script_load_from_data; after that, each save
+// is parsed and compared with the previous version object by object
+// (matched by "id"), and only the differences are applied to the live
+// actors: changed properties are set, removed ones go back to their
+// default, new objects are created, deleted ones destroyed and moved ones
+// reparented.  Nothing is unmerged or rebuilt, so running timelines,
+// behaviours and tweens carry on.
+//
+// Objects without an id, and anything that isn't an actor, are created by
+// the first load and left alone afterwards.  Root actors are added to the
+// stage; don't put a ClutterStage in the file.
+class ofxClutterLiveScene {
+public:
+	ofxClutterLiveScene();
+	~ofxClutterLiveScene();
+	
+	bool load(string jsonPath);
+	void clear();		// destroys the actors
+	
+	// Checks the file every intervalMillis and reloads it when it changes
+	void watch(bool enabled=true, int intervalMillis=250);
+	bool reload();
+	
+	ClutterActor* get(string id);
+	ClutterScript* getScript() { return script; }
+	
+	// What the last reload did
+	int getNumPropertiesChanged() { return numPropertiesChanged; }
+	int getNumCreated() { return numCreated; }
+	int getNumDestroyed() { return numDestroyed; }
+	int getNumMoved() { return numMoved; }
+	float getReloadMillis() { return reloadMillis; }
+	
+protected:
+	struct Object {
+		string type;
+		string parent;			// "" for a root
+		bool untrackedParent;	// the parent has no id, so it is left where it is
+		vector<string> children;
+		map<string, JsonNode*> properties;		// owned by the parser
+	};
+	typedef map<string, Object> Snapshot;
+	
+	bool parse(const gchar* data, gsize length, JsonParser*& result, Snapshot& snapshot, vector<string>& roots);
+	void collect(JsonObject* object, const string& parent, bool untrackedParent, Snapshot& snapshot,
+				 vector<string>& topLevel, vector<pair<string, string> >& references);
+	void applyProperties(ClutterActor* actor, const string& id, const Object& object, const Object* previous);
+	void restack(const vector<string>& ids);
+	static gboolean onPoll(gpointer data);
+	
+	string path;
+	ClutterScript* script;
+	JsonParser* parser;			// keeps the current snapshot's nodes alive
+	Snapshot current;
+	vector<string> roots;
+	map<string, ClutterActor*> actors;		// referenced
+	vector<ClutterActor*> anonymousRoots;	// roots without an id, referenced
+	
+	guint pollSource;
+	time_t lastMTime;
+	off_t lastSize;
+	
+	int numPropertiesChanged, numCreated, numDestroyed, numMoved;
+	float reloadMillis;
+};
@@ -0,0 +1,272 @@
+/*
+ *  ofxClutterLogView.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterLogView.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+//------------------------------------------------------------
+ofxClutterLogView::ofxClutterLogView(int w, int h, string font) {
+	actor = clutter_group_new();
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_set_clip_to_allocation(actor, TRUE);
+	clutter_actor_show(actor);
+	
+	this->font = font;
+	ClutterColor black = { 0, 0, 0, 255 };
+	color = black;
+	lineHeight = ofxClutterText::measure("Ag", font).y;
+	if(lineHeight < 1) lineHeight = 1;
+	
+	chunkSize = 256 * 1024;
+	maxBytes = 64 * 1024 * 1024;
+	numBytes = 0;
+	firstLine = 0;
+	numLines = 0;
+	
+	scrollLine = 0;
+	scrollOffset = 0;
+	followTail = true;
+	numTextUpdates = 0;
+	needsUpdate = true;
+	
+	setSize(w, h);
+}
+
+
+//------------------------------------------------------------
+ofxClutterLogView::~ofxClutterLogView() {
+	for(int i=0; i<rows.size(); i++) delete rows[i];
+	clutter_actor_destroy(actor);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::setSize(int w, int h) {
+	viewWidth = w;
+	viewHeight = h;
+	clutter_actor_set_size(actor, w, h);
+	createRows();
+}
+
+
+//------------------------------------------------------------
+// One row per line that can be partly visible
+void ofxClutterLogView::createRows() {
+	int numRows = ceil(viewHeight / lineHeight) + 1;
+	
+	while(rows.size() > numRows) {
+		clutter_actor_destroy(rows.back()->actor);
+		delete rows.back();
+		rows.pop_back();
+	}
+	while(rows.size() < numRows) {
+		ofxClutterText* row = new ofxClutterText("", font);
+		clutter_actor_reparent(row->actor, actor);
+		clutter_text_set_single_line_mode(CLUTTER_TEXT(row->actor), TRUE);
+		row->setEllipsize(PANGO_ELLIPSIZE_END);
+		rows.push_back(row);
+	}
+	
+	for(int i=0; i<rows.size(); i++) {
+		rows[i]->setColor(color.red, color.green, color.blue, color.alpha);
+		rows[i]->setWrapWidth(viewWidth);
+	}
+	
+	// The line -> row mapping depends on the row count
+	rowLines.assign(rows.size(), -1);
+	needsUpdate = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::setColor(int r, int g, int b, int a) {
+	ClutterColor c = { r, g, b, a };
+	color = c;
+	for(int i=0; i<rows.size(); i++) {
+		rows[i]->setColor(r, g, b, a);
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::append(string text) {
+	// A trailing newline ends the last line rather than starting an empty one
+	size_t start = 0;
+	do {
+		size_t end = text.find('\n', start);
+		if(end == string::npos) end = text.size();
+		addLine(text.c_str() + start, end - start);
+		start = end + 1;
+	} while(start < text.size());
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::addLine(const char* text, int length) {
+	// Start a new chunk when this one is full; a very long line gets a
+	// chunk of its own size rather than being split.
+	if(chunks.empty() || chunks.back().data.size() + length > chunkSize) {
+		chunks.push_back(Chunk());
+		Chunk& chunk = chunks.back();
+		chunk.firstLine = firstLine + numLines;
+		chunk.data.reserve(MAX(chunkSize, length));
+		numBytes += chunk.data.capacity();
+	}
+	
+	Chunk& chunk = chunks.back();
+	chunk.lineStarts.push_back(chunk.data.size());
+	chunk.data.insert(chunk.data.end(), text, text + length);
+	numBytes += sizeof(int);
+	numLines++;
+	
+	// Drop the oldest chunks, but always keep the one being written
+	while(numBytes > maxBytes && chunks.size() > 1) {
+		Chunk& oldest = chunks.front();
+		int dropped = oldest.lineStarts.size();
+		numBytes -= oldest.data.capacity() + dropped * sizeof(int);
+		firstLine += dropped;
+		numLines -= dropped;
+		scrollLine -= dropped;
+		if(scrollLine < 0) scrollLine = scrollOffset = 0;
+		chunks.pop_front();
+	}
+	
+	needsUpdate = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::clear() {
+	chunks.clear();
+	numBytes = 0;
+	firstLine += numLines;
+	numLines = 0;
+	scrollLine = 0;
+	scrollOffset = 0;
+	followTail = true;
+	rowLines.assign(rows.size(), -1);
+	needsUpdate = true;
+}
+
+
+//------------------------------------------------------------
+string ofxClutterLogView::getLine(int n) {
+	if(n < 0 || n >= numLines) return "";
+	int line = firstLine + n;
+	
+	// Last chunk whose first line is <= line
+	int lo = 0;
+	int hi = chunks.size() - 1;
+	while(lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if(chunks[mid].firstLine <= line) lo = mid;
+		else hi = mid - 1;
+	}
+	
+	Chunk& chunk = chunks[lo];
+	int i = line - chunk.firstLine;
+	int start = chunk.lineStarts[i];
+	int end = (i+1 < chunk.lineStarts.size()) ? chunk.lineStarts[i+1] : chunk.data.size();
+	return string(chunk.data.begin() + start, chunk.data.begin() + end);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterLogView::getMemoryBytes() {
+	return numBytes;
+}
+
+
+//------------------------------------------------------------
+// The furthest the view can scroll: the last line at the bottom edge
+void ofxClutterLogView::getBottom(int& line, float& offset) {
+	int visible = viewHeight / lineHeight;
+	float rest = viewHeight - visible * lineHeight;
+	line = numLines - visible;
+	offset = 0;
+	if(rest > 0) {
+		line--;
+		offset = lineHeight - rest;
+	}
+	if(line < 0) {
+		line = 0;
+		offset = 0;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::scrollToLine(int line, float offset) {
+	// Carry whole lines out of the offset
+	int lines = floorf(offset / lineHeight);
+	line += lines;
+	offset -= lines * lineHeight;
+	
+	int bottomLine;
+	float bottomOffset;
+	getBottom(bottomLine, bottomOffset);
+	if(line < 0) {
+		line = 0;
+		offset = 0;
+	}
+	followTail = (line > bottomLine || (line == bottomLine && offset >= bottomOffset));
+	if(followTail) {
+		line = bottomLine;
+		offset = bottomOffset;
+	}
+	scrollLine = line;
+	scrollOffset = offset;
+	needsUpdate = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::scrollToBottom() {
+	followTail = true;
+	needsUpdate = true;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterLogView::isAtBottom() {
+	return followTail;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterLogView::update() {
+	if(!needsUpdate) return;
+	needsUpdate = false;
+	
+	if(followTail) {
+		getBottom(scrollLine, scrollOffset);
+	}
+	
+	// Rows are placed relative to the top line, so positions stay small
+	int first = scrollLine;
+	int numRows = rows.size();
+	for(int line=first; line<first+numRows; line++) {
+		int r = (firstLine + line) % numRows;
+		ofxClutterText* row = rows[r];
+		if(line >= numLines) {
+			clutter_actor_hide(row->actor);
+			rowLines[r] = -1;
+			continue;
+		}
+		if(rowLines[r] != firstLine + line) {
+			row->setText(getLine(line));
+			rowLines[r] = firstLine + line;
+			numTextUpdates++;
+		}
+		clutter_actor_set_position(row->actor, 0, (line - first) * lineHeight - scrollOffset);
+		clutter_actor_show(row->actor);
+	}
+}
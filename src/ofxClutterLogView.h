@@ -0,0 +1,86 @@
+/*
+ *  ofxClutterLogView.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterText.h"
+
+
+// A scrolling view of a very long, growing log.
+//
+// The text is kept in an append-only list of fixed size chunks, each with
+// an index of where its lines start, so appending never copies old text
+// and finding a line is a binary search.  Once the log is over its memory
+// limit the oldest chunks are dropped.
+//
+// Only as many ofxClutterText actors as fit in the view exist.  Line n is
+// always shown by actor n % numRows, so scrolling by a line re-sets the text
+// of one actor and just moves the others.
+class ofxClutterLogView : public ofxClutterActor {
+public:
+	ofxClutterLogView(int w, int h, string font="Monospace 10");
+	~ofxClutterLogView();
+	
+	// Text may hold several lines separated by '\n'
+	void append(string text);
+	void clear();
+	
+	void setSize(int w, int h);
+	void setColor(int r, int g, int b, int a=255);
+	void setMaxBytes(int bytes) { maxBytes = bytes; }
+	
+	// The scroll position is the line at the top of the view (0 is the
+	// oldest line kept) and how many pixels of it are scrolled off, so it
+	// stays exact however long the log gets.  While scrolled to the bottom,
+	// the view follows new lines.
+	void scrollToLine(int line, float offset=0);
+	void scrollTo(float y) { scrollToLine(0, y); }		// pixels from the top of line 0
+	void scrollBy(float dy) { scrollToLine(scrollLine, scrollOffset + dy); }
+	void scrollToBottom();
+	bool isAtBottom();
+	int getScrollLine() { return scrollLine; }
+	
+	// Lay out the visible lines; call every frame
+	void update();
+	
+	int getNumLines() { return numLines; }
+	int getNumDroppedLines() { return firstLine; }
+	string getLine(int n);				// 0 is the oldest line kept
+	int getMemoryBytes();
+	int getNumRows() { return rows.size(); }
+	int getNumTextUpdates() { return numTextUpdates; }
+	
+protected:
+	struct Chunk {
+		int firstLine;				// line number of lineStarts[0]
+		vector<char> data;
+		vector<int> lineStarts;
+	};
+	
+	void addLine(const char* text, int length);
+	void createRows();
+	void getBottom(int& line, float& offset);
+	
+	string font;
+	ClutterColor color;
+	int viewWidth, viewHeight;
+	float lineHeight;
+	
+	deque<Chunk> chunks;
+	int chunkSize;
+	int maxBytes;
+	int numBytes;
+	int firstLine;					// lines dropped so far
+	int numLines;
+	
+	int scrollLine;
+	float scrollOffset;				// 0 to lineHeight
+	bool followTail;
+	
+	vector<ofxClutterText*> rows;
+	vector<int> rowLines;			// line each row currently shows, -1 if none
+	int numTextUpdates;
+	bool needsUpdate;
+};
@@ -0,0 +1,105 @@
+/*
+ *  ofxClutterOffscreenPool.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterOffscreenPool.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+list<ofxClutterOffscreenPool::Target> ofxClutterOffscreenPool::freeTargets;
+map<CoglHandle, ofxClutterOffscreenPool::Target> ofxClutterOffscreenPool::inUse;
+vector<CoglHandle> ofxClutterOffscreenPool::releasing;
+int ofxClutterOffscreenPool::maxFree = 16;
+int ofxClutterOffscreenPool::numAllocations = 0;
+int ofxClutterOffscreenPool::numReuses = 0;
+
+
+//------------------------------------------------------------
+CoglHandle ofxClutterOffscreenPool::acquire(int w, int h) {
+	for(list<Target>::iterator it = freeTargets.begin(); it != freeTargets.end(); ++it) {
+		if(it->width == w && it->height == h) {
+			Target t = *it;
+			freeTargets.erase(it);
+			inUse[t.texture] = t;
+			numReuses++;
+			return t.texture;
+		}
+	}
+	
+	Target t;
+	t.texture = cogl_texture_new_with_size(w, h, (CoglTextureFlags)(COGL_TEXTURE_NO_SLICING | COGL_TEXTURE_NO_ATLAS),
+										   COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+	if(t.texture == COGL_INVALID_HANDLE) {
+		ofLog(OF_LOG_ERROR, "ofxClutterOffscreenPool: couldn't create a " + ofToString(w) + "x" + ofToString(h) + " texture");
+		return COGL_INVALID_HANDLE;
+	}
+	t.framebuffer = COGL_INVALID_HANDLE;
+	t.width = w;
+	t.height = h;
+	inUse[t.texture] = t;
+	numAllocations++;
+	return t.texture;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterOffscreenPool::release(CoglHandle texture) {
+	map<CoglHandle, Target>::iterator it = inUse.find(texture);
+	if(it == inUse.end()) return;
+	freeTargets.push_front(it->second);
+	inUse.erase(it);
+	trim();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterOffscreenPool::releaseAfterFrame(CoglHandle texture) {
+	static bool stageConnected = false;
+	if(!stageConnected) {
+		g_signal_connect_after(stage, "paint", G_CALLBACK(onStagePainted), NULL);
+		stageConnected = true;
+	}
+	releasing.push_back(texture);
+}
+
+
+//------------------------------------------------------------
+CoglHandle ofxClutterOffscreenPool::getFramebuffer(CoglHandle texture) {
+	map<CoglHandle, Target>::iterator it = inUse.find(texture);
+	if(it == inUse.end()) return COGL_INVALID_HANDLE;
+	if(it->second.framebuffer == COGL_INVALID_HANDLE) {
+		it->second.framebuffer = cogl_offscreen_new_to_texture(texture);
+	}
+	return it->second.framebuffer;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterOffscreenPool::setMaxFree(int maxFree) {
+	ofxClutterOffscreenPool::maxFree = maxFree;
+	trim();
+}
+
+
+//------------------------------------------------------------
+// Drops the least recently released targets
+void ofxClutterOffscreenPool::trim() {
+	while(freeTargets.size() > maxFree) {
+		Target& t = freeTargets.back();
+		if(t.framebuffer != COGL_INVALID_HANDLE) cogl_handle_unref(t.framebuffer);
+		cogl_handle_unref(t.texture);
+		freeTargets.pop_back();
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterOffscreenPool::onStagePainted(ClutterActor* actor, gpointer data) {
+	for(int i=0; i<releasing.size(); i++) release(releasing[i]);
+	releasing.clear();
+}
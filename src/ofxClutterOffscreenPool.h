@@ -0,0 +1,52 @@
+/*
+ *  ofxClutterOffscreenPool.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include <clutter/clutter.h>
+
+
+// Shared pool of offscreen render targets.  Effects acquire an RGBA
+// texture of the size they need and release it when they are detached
+// or resized, so toggling an effect on hover reuses a texture (and its
+// framebuffer) instead of allocating new ones.
+class ofxClutterOffscreenPool {
+public:
+	static CoglHandle acquire(int w, int h);
+	static void release(CoglHandle texture);
+	
+	// For textures that may still be drawn from this frame; they go back
+	// to the pool once the stage has finished painting.
+	static void releaseAfterFrame(CoglHandle texture);
+	
+	// Framebuffer that renders into a pooled texture, created on first use
+	static CoglHandle getFramebuffer(CoglHandle texture);
+	
+	// Free targets kept around for reuse (default 16); extra ones are destroyed
+	static void setMaxFree(int maxFree);
+	
+	static int getNumInUse() { return inUse.size(); }
+	static int getNumFree() { return freeTargets.size(); }
+	static int getNumAllocations() { return numAllocations; }
+	static int getNumReuses() { return numReuses; }
+	
+protected:
+	struct Target {
+		CoglHandle texture;
+		CoglHandle framebuffer;
+		int width, height;
+	};
+	
+	static void trim();
+	static void onStagePainted(ClutterActor* actor, gpointer data);
+	
+	static list<Target> freeTargets;		// most recently released first
+	static map<CoglHandle, Target> inUse;
+	static vector<CoglHandle> releasing;
+	static int maxFree;
+	static int numAllocations;
+	static int numReuses;
+};
@@ -0,0 +1,312 @@
+/*
+ *  ofxClutterPath.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterPath.h"
+
+// Line segments per bezier when flattening
+static const int curveSegments = 32;
+
+
+//------------------------------------------------------------
+ofxClutterPath::ofxClutterPath(int resolution) {
+	path = clutter_path_new();
+	g_object_ref_sink(path);
+	this->resolution = MAX(resolution, 1);
+	dirty = true;
+	length = 0;
+	rotateFollowers = false;
+	progress = 0;
+	timeline = NULL;
+}
+
+
+//------------------------------------------------------------
+ofxClutterPath::~ofxClutterPath() {
+	stop();
+	for(int i=0; i<followers.size(); i++) g_object_unref(followers[i]);
+	g_object_unref(path);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::moveTo(float x, float y) {
+	clutter_path_add_move_to(path, x, y);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::lineTo(float x, float y) {
+	clutter_path_add_line_to(path, x, y);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::curveTo(float x1, float y1, float x2, float y2, float x3, float y3) {
+	clutter_path_add_curve_to(path, x1, y1, x2, y2, x3, y3);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::close() {
+	clutter_path_add_close(path);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterPath::setDescription(string description) {
+	dirty = true;
+	if(!clutter_path_set_description(path, description.c_str())) {
+		ofLog(OF_LOG_ERROR, "ofxClutterPath: couldn't parse path " + description);
+		return false;
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::clear() {
+	clutter_path_clear(path);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::setResolution(int resolution) {
+	this->resolution = MAX(resolution, 1);
+	dirty = true;
+}
+
+
+//------------------------------------------------------------
+// Turns the nodes into one polyline; relative nodes are made absolute and
+// each bezier becomes curveSegments lines.  A move starts a new subpath:
+// its point is flagged in breaks, and the jump to it isn't part of the
+// path.  Moves with nothing drawn after them replace each other.
+void ofxClutterPath::flatten(vector<float>& xs, vector<float>& ys, vector<bool>& breaks) {
+	float lastX = 0, lastY = 0, startX = 0, startY = 0;
+	bool moved = false;
+	int n = clutter_path_get_n_nodes(path);
+	for(int i=0; i<n; i++) {
+		ClutterPathNode node;
+		clutter_path_get_node(path, i, &node);
+		float px[3], py[3];
+		for(int j=0; j<3; j++) {
+			px[j] = node.points[j].x;
+			py[j] = node.points[j].y;
+			if(node.type & CLUTTER_PATH_RELATIVE) {
+				px[j] += lastX;
+				py[j] += lastY;
+			}
+		}
+		
+		switch(node.type & ~CLUTTER_PATH_RELATIVE) {
+			case CLUTTER_PATH_MOVE_TO:
+				startX = lastX = px[0];
+				startY = lastY = py[0];
+				if(moved) {
+					xs.pop_back();
+					ys.pop_back();
+					breaks.pop_back();
+				}
+				breaks.push_back(!xs.empty());
+				xs.push_back(px[0]);
+				ys.push_back(py[0]);
+				moved = true;
+				break;
+			case CLUTTER_PATH_LINE_TO:
+				xs.push_back(lastX = px[0]);
+				ys.push_back(lastY = py[0]);
+				breaks.push_back(false);
+				moved = false;
+				break;
+			case CLUTTER_PATH_CURVE_TO:
+				for(int s=1; s<=curveSegments; s++) {
+					float t = s / (float)curveSegments;
+					float u = 1 - t;
+					float a = u*u*u, b = 3*u*u*t, c = 3*u*t*t, d = t*t*t;
+					xs.push_back(a*lastX + b*px[0] + c*px[1] + d*px[2]);
+					ys.push_back(a*lastY + b*py[0] + c*py[1] + d*py[2]);
+					breaks.push_back(false);
+				}
+				lastX = px[2];
+				lastY = py[2];
+				moved = false;
+				break;
+			case CLUTTER_PATH_CLOSE:
+				xs.push_back(lastX = startX);
+				ys.push_back(lastY = startY);
+				breaks.push_back(false);
+				moved = false;
+				break;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+// Walks the polyline once, dropping a table point every length/resolution.
+// Jumps between subpaths have no length; the table step each one falls in
+// remembers where, so lookups don't slide across the gap.
+void ofxClutterPath::build() {
+	dirty = false;
+	tableX.clear();
+	tableY.clear();
+	tableBreaks.clear();
+	length = 0;
+	
+	vector<float> xs, ys;
+	vector<bool> breaks;
+	flatten(xs, ys, breaks);
+	int n = xs.size();
+	if(n == 0) return;
+	
+	vector<float> distances(n, 0);
+	for(int i=1; i<n; i++) {
+		float dx = xs[i] - xs[i-1];
+		float dy = ys[i] - ys[i-1];
+		distances[i] = distances[i-1] + (breaks[i] ? 0 : sqrtf(dx*dx + dy*dy));
+	}
+	length = distances[n-1];
+	
+	tableX.resize(resolution + 1, xs[0]);
+	tableY.resize(resolution + 1, ys[0]);
+	tableBreaks.resize(resolution, -1);
+	if(n == 1 || length <= 0) return;
+	
+	for(int i=1; i<n; i++) {
+		if(!breaks[i]) continue;
+		float f = distances[i] / length * resolution;
+		int step = (int)f;
+		if(step < resolution) tableBreaks[step] = f - step;
+	}
+	
+	int segment = 1;
+	for(int i=0; i<=resolution; i++) {
+		float d = length * i / resolution;
+		while(segment < n-1 && distances[segment] < d) segment++;
+		float span = distances[segment] - distances[segment-1];
+		float t = (span > 0) ? CLAMP((d - distances[segment-1]) / span, 0, 1) : 0;
+		tableX[i] = xs[segment-1] + (xs[segment] - xs[segment-1]) * t;
+		tableY[i] = ys[segment-1] + (ys[segment] - ys[segment-1]) * t;
+	}
+}
+
+
+//------------------------------------------------------------
+float ofxClutterPath::getLength() {
+	if(dirty) build();
+	return length;
+}
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterPath::getPointAtProgress(float progress) {
+	if(dirty) build();
+	if(tableX.empty()) return ofPoint();
+	
+	float f = CLAMP(progress, 0, 1) * resolution;
+	int i = MIN((int)f, resolution - 1);
+	float t = f - i;
+	if(tableBreaks[i] >= 0) {
+		// Stay on one side of the jump
+		return (t < tableBreaks[i]) ? ofPoint(tableX[i], tableY[i]) : ofPoint(tableX[i+1], tableY[i+1]);
+	}
+	return ofPoint(tableX[i] + (tableX[i+1] - tableX[i]) * t,
+				   tableY[i] + (tableY[i+1] - tableY[i]) * t);
+}
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterPath::getPointAtDistance(float distance) {
+	float l = getLength();
+	return getPointAtProgress(l > 0 ? distance / l : 0);
+}
+
+
+//------------------------------------------------------------
+float ofxClutterPath::getAngleAtProgress(float progress) {
+	if(dirty) build();
+	if(tableX.size() < 2) return 0;
+	float f = CLAMP(progress, 0, 1) * resolution;
+	int i = MIN((int)f, resolution - 1);
+	if(tableBreaks[i] >= 0) {
+		// The step across a jump has no direction; use a neighbour on the same side
+		if(f - i < tableBreaks[i]) {
+			if(i > 0) i--;
+		}
+		else if(i < resolution - 1) i++;
+	}
+	return atan2f(tableY[i+1] - tableY[i], tableX[i+1] - tableX[i]) * 180 / M_PI;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::addFollower(ofxClutterActor* actor, float offset) {
+	g_object_ref(actor->actor);
+	followers.push_back(actor->actor);
+	offsets.push_back(offset);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::removeFollower(ofxClutterActor* actor) {
+	for(int i=0; i<followers.size(); i++) {
+		if(followers[i] == actor->actor) {
+			g_object_unref(followers[i]);
+			followers.erase(followers.begin() + i);
+			offsets.erase(offsets.begin() + i);
+			return;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::setProgress(float progress) {
+	this->progress = progress;
+	if(dirty) build();
+	if(tableX.empty()) return;
+	
+	for(int i=0; i<followers.size(); i++) {
+		// Wrap, but leave 1 alone so a run that stops at the end ends there
+		float p = progress + offsets[i];
+		if(p < 0 || p > 1) p -= floorf(p);
+		ofPoint pos = getPointAtProgress(p);
+		clutter_actor_set_position(followers[i], pos.x, pos.y);
+		if(rotateFollowers) {
+			clutter_actor_set_rotation(followers[i], CLUTTER_Z_AXIS, getAngleAtProgress(p), 0, 0, 0);
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::start(float durationMillis, bool loop) {
+	stop();
+	timeline = clutter_timeline_new(durationMillis);
+	clutter_timeline_set_loop(timeline, loop);
+	g_signal_connect(timeline, "new-frame", G_CALLBACK(onNewFrame), this);
+	clutter_timeline_start(timeline);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::stop() {
+	if(timeline == NULL) return;
+	clutter_timeline_stop(timeline);
+	g_object_unref(timeline);
+	timeline = NULL;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPath::onNewFrame(ClutterTimeline* timeline, gint msecs, gpointer data) {
+	((ofxClutterPath*)data)->setProgress(clutter_timeline_get_progress(timeline));
+}
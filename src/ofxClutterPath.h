@@ -0,0 +1,74 @@
+/*
+ *  ofxClutterPath.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+
+
+// A ClutterPath with a table of points spaced evenly by arc length, so
+// positions along it move at constant speed (ClutterBehaviourPath slows
+// down and speeds up with the spacing of the nodes and bezier handles)
+// and a lookup is an index and a lerp.  Any number of actors can follow
+// the same path, each at its own offset, driven by one timeline.  A move
+// starts a new subpath; followers jump straight from the end of one to
+// the start of the next, and the gap doesn't count towards the length.
+class ofxClutterPath {
+public:
+	ofxClutterPath(int resolution=1024);
+	~ofxClutterPath();
+	
+	void moveTo(float x, float y);
+	void lineTo(float x, float y);
+	void curveTo(float x1, float y1, float x2, float y2, float x3, float y3);
+	void close();
+	bool setDescription(string description);	// ClutterPath/SVG syntax, e.g. "M 0 0 L 100 0 C ..."
+	void clear();
+	
+	// Call after changing the ClutterPath directly
+	void invalidate() { dirty = true; }
+	
+	// Number of table entries; more is smoother on long, curvy paths
+	void setResolution(int resolution);
+	
+	float getLength();
+	ofPoint getPointAtProgress(float progress);		// 0..1 of the length
+	ofPoint getPointAtDistance(float distance);
+	float getAngleAtProgress(float progress);			// direction of travel in degrees
+	
+	// Followers are placed at progress + offset, wrapped to 0..1
+	void addFollower(ofxClutterActor* actor, float offset=0);
+	void removeFollower(ofxClutterActor* actor);
+	void setRotateFollowers(bool rotate) { rotateFollowers = rotate; }
+	void setProgress(float progress);
+	float getProgress() { return progress; }
+	
+	// Moves the followers once along the path over durationMillis
+	void start(float durationMillis, bool loop=true);
+	void stop();
+	
+	// For ClutterBehaviourPath users; the behaviour won't be constant speed
+	ClutterBehaviour* createBehaviour(ClutterAlpha* alpha) { return clutter_behaviour_path_new(alpha, path); }
+	
+	ClutterPath* path;
+	
+protected:
+	void build();
+	void flatten(vector<float>& xs, vector<float>& ys, vector<bool>& breaks);
+	static void onNewFrame(ClutterTimeline* timeline, gint msecs, gpointer data);
+	
+	int resolution;
+	bool dirty;
+	float length;
+	vector<float> tableX;		// resolution + 1 points, length / resolution apart
+	vector<float> tableY;
+	vector<float> tableBreaks;	// per step: where in it a jump between subpaths is, or -1
+	
+	vector<ClutterActor*> followers;
+	vector<float> offsets;
+	bool rotateFollowers;
+	float progress;
+	ClutterTimeline* timeline;
+};
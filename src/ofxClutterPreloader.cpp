@@ -0,0 +1,254 @@
+/*
+ *  ofxClutterPreloader.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterPreloader.h"
+
+
+// Decodes one image on a worker thread
+class ofxClutterDecodeJob : public ofxClutterJob {
+public:
+	ofxClutterDecodeJob(ofxClutterPreloader* owner, string path)
+	: owner(owner), path(path), success(false), millis(0) {}
+	
+	void run() {
+		GTimer* timer = g_timer_new();
+		img.setUseTexture(false);
+		success = img.loadImage(path);
+		// Textures only take RGB and RGBA
+		if(success && img.type == OF_IMAGE_GRAYSCALE) {
+			img.setImageType(OF_IMAGE_COLOR);
+		}
+		millis = g_timer_elapsed(timer, NULL) * 1000;
+		g_timer_destroy(timer);
+	}
+	
+	void finish() {
+		owner->imageDecoded(path, img, success, millis);
+	}
+	
+	ofxClutterPreloader* owner;
+	string path;
+	ofImage img;
+	bool success;
+	float millis;
+};
+
+
+//------------------------------------------------------------
+ofxClutterPreloader::ofxClutterPreloader() {
+	pool = NULL;
+	started = false;
+	numThreads = 0;
+	uploadBudget = 4;
+	maxInFlight = 0;
+	numQueued = 0;
+	numFinished = numFailed = 0;
+	numFrames = uploadsLastFrame = 0;
+	decodedBytes = 0;
+	decodeMillis = uploadMillis = 0;
+	startTime = endTime = 0;
+}
+
+
+//------------------------------------------------------------
+ofxClutterPreloader::~ofxClutterPreloader() {
+	delete pool;
+	for(map<string, ofxClutterTexture*>::iterator it = textures.begin(); it != textures.end(); ++it) {
+		clutter_actor_destroy(it->second->actor);
+		delete it->second;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPreloader::addImage(string path) {
+	if(started) {
+		ofLog(OF_LOG_WARNING, "ofxClutterPreloader: already started, ignoring " + path);
+		return;
+	}
+	paths.push_back(path);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterPreloader::addDirectory(string dir) {
+	GDir* d = g_dir_open(ofToDataPath(dir, true).c_str(), 0, NULL);
+	if(!d) {
+		ofLog(OF_LOG_ERROR, "ofxClutterPreloader: couldn't open " + dir);
+		return 0;
+	}
+	
+	static const char* extensions[] = { ".jpg", ".jpeg", ".png", ".gif", ".bmp", ".tif", ".tiff" };
+	vector<string> found;
+	const gchar* name;
+	while((name = g_dir_read_name(d))) {
+		gchar* lower = g_ascii_strdown(name, -1);
+		for(int i=0; i<sizeof(extensions)/sizeof(extensions[0]); i++) {
+			if(g_str_has_suffix(lower, extensions[i])) {
+				found.push_back(dir + "/" + name);
+				break;
+			}
+		}
+		g_free(lower);
+	}
+	g_dir_close(d);
+	
+	// Directory order is arbitrary; keep loading order stable between runs
+	sort(found.begin(), found.end());
+	for(int i=0; i<found.size(); i++) {
+		addImage(found[i]);
+	}
+	return found.size();
+}
+
+
+//------------------------------------------------------------
+int ofxClutterPreloader::addManifest(string file) {
+	ifstream manifest(ofToDataPath(file, true).c_str());
+	if(!manifest) {
+		ofLog(OF_LOG_ERROR, "ofxClutterPreloader: couldn't open " + file);
+		return 0;
+	}
+	
+	int count = 0;
+	string line;
+	while(getline(manifest, line)) {
+		gchar* path = g_strstrip(g_strdup(line.c_str()));
+		if(path[0] && path[0] != '#') {
+			addImage(path);
+			count++;
+		}
+		g_free(path);
+	}
+	return count;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPreloader::start(int numThreads) {
+	if(started) return;
+	started = true;
+	startTime = ofGetElapsedTimeMillis();
+	
+	pool = new ofxClutterWorkerPool(numThreads);
+	this->numThreads = pool->getNumThreads();
+	queueImages();
+	if(paths.empty()) endTime = startTime;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPreloader::queueImages() {
+	int limit = getInFlightLimit();
+	while(numQueued < paths.size() && pool->getNumPending() < limit) {
+		pool->push(new ofxClutterDecodeJob(this, paths[numQueued++]));
+	}
+}
+
+
+//------------------------------------------------------------
+// Enough for every thread to have one image on the go while the main thread
+// has two frames of uploads ready to go.  Until the first uploads are
+// timed, assume one per frame.
+int ofxClutterPreloader::getInFlightLimit() {
+	if(maxInFlight > 0) return maxInFlight;
+	int uploadsPerFrame = 1;
+	if(numFinished > 0 && uploadMillis > 0) {
+		uploadsPerFrame = MAX(1, (int)(uploadBudget / (uploadMillis / numFinished)));
+	}
+	return numThreads + 2 * uploadsPerFrame;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPreloader::update() {
+	if(!pool || isDone()) return;
+	
+	int start = ofGetElapsedTimeMillis();
+	uploadsLastFrame = pool->finishJobs(-1, uploadBudget);
+	uploadMillis += ofGetElapsedTimeMillis() - start;
+	numFrames++;
+	queueImages();
+	
+	if(isDone()) {
+		endTime = ofGetElapsedTimeMillis();
+		ofLog(OF_LOG_NOTICE, getReport());
+		
+		// Nothing left for the threads to do
+		delete pool;
+		pool = NULL;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterPreloader::imageDecoded(string path, ofImage& img, bool success, float millis) {
+	numFinished++;
+	decodeMillis += millis;
+	if(!success) {
+		ofLog(OF_LOG_ERROR, "ofxClutterPreloader: couldn't decode " + path);
+		numFailed++;
+		return;
+	}
+	
+	int bpp = img.bpp / 8;
+	decodedBytes += (double)img.width * img.height * bpp;
+	
+	ofxClutterTexture* tex = new ofxClutterTexture();
+	clutter_actor_hide(tex->actor);
+	if(!tex->setFromPixels(img.getPixels(), img.width, img.height, bpp)) {
+		clutter_actor_destroy(tex->actor);
+		delete tex;
+		numFailed++;
+		return;
+	}
+	textures[path] = tex;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTexture* ofxClutterPreloader::getTexture(string path) {
+	map<string, ofxClutterTexture*>::iterator it = textures.find(path);
+	return (it == textures.end()) ? NULL : it->second;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTexture* ofxClutterPreloader::takeTexture(string path) {
+	map<string, ofxClutterTexture*>::iterator it = textures.find(path);
+	if(it == textures.end()) return NULL;
+	ofxClutterTexture* tex = it->second;
+	textures.erase(it);
+	return tex;
+}
+
+
+//------------------------------------------------------------
+float ofxClutterPreloader::getWallMillis() {
+	if(!started) return 0;
+	return (isDone() ? endTime : ofGetElapsedTimeMillis()) - startTime;
+}
+
+
+//------------------------------------------------------------
+float ofxClutterPreloader::getDecodeMBPerSecond() {
+	float seconds = getWallMillis() / 1000.0;
+	return (seconds > 0) ? decodedBytes / (1024*1024) / seconds : 0;
+}
+
+
+//------------------------------------------------------------
+string ofxClutterPreloader::getReport() {
+	ostringstream report;
+	report << "preloaded " << getNumLoaded() << "/" << getNumImages() << " images";
+	if(numFailed) report << " (" << numFailed << " failed)";
+	report << " in " << getWallMillis() << " ms"
+		   << ", decode " << getDecodeMBPerSecond() << " MB/s"
+		   << " (" << decodeMillis << " ms on " << numThreads << " threads)"
+		   << ", " << getUploadsPerFrame() << " uploads/frame"
+		   << ", " << uploadMillis << " ms uploading";
+	return report.str();
+}
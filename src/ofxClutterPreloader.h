@@ -0,0 +1,100 @@
+/*
+ *  ofxClutterPreloader.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterTexture.h"
+#include "ofxClutterWorkerPool.h"
+
+
+// Loads a batch of images into ofxClutterTextures up front.  Files are
+// decoded on worker threads; the uploads happen in update() on the main
+// thread, but only for as long as the per-frame budget allows, so the
+// stage keeps animating while a loading screen is up.  Files are handed to
+// the workers a few at a time, so decoded images waiting for an upload
+// don't pile up in memory when decoding outpaces the budget.
+//
+//	preloader.addDirectory("photos");
+//	preloader.start();
+//	...
+//	void testApp::update() {
+//		preloader.update();
+//		if(preloader.isDone()) clutter_actor_show(preloader.getTexture("photos/cat.jpg")->actor);
+//	}
+//
+// The preloader owns the textures (they start hidden) and destroys their
+// actors when it is deleted, so keep it around as long as they're in use,
+// or take the ones you keep with takeTexture().
+class ofxClutterPreloader {
+public:
+	ofxClutterPreloader();
+	~ofxClutterPreloader();
+	
+	// Queue images.  Paths are relative to the data folder, and are also
+	// the names the textures are looked up by.
+	void addImage(string path);
+	int addDirectory(string dir);		// jpg, jpeg, png, gif, bmp, tif, tiff
+	int addManifest(string file);		// one path per line, # starts a comment
+	
+	// 0 threads means one per processor
+	void start(int numThreads=0);
+	void update();
+	
+	// Main thread milliseconds per update() spent uploading
+	void setUploadBudget(int millis) { uploadBudget = millis; }
+	
+	// Images being decoded or waiting to be uploaded.  0 (the default) is a
+	// thread's worth each plus two frames' worth of uploads, from the upload
+	// times so far.
+	void setMaxInFlight(int n) { maxInFlight = n; }
+	int getNumInFlight() { return pool ? pool->getNumPending() : 0; }
+	
+	bool isDone() { return started && numFinished == paths.size(); }
+	float getProgress() { return paths.empty() ? 1 : (float)numFinished / paths.size(); }
+	int getNumImages() { return paths.size(); }
+	int getNumLoaded() { return numFinished - numFailed; }
+	int getNumFailed() { return numFailed; }
+	
+	ofxClutterTexture* getTexture(string path);
+	
+	// Hands the texture over: the preloader forgets it, and deleting it and
+	// destroying its actor are up to the caller
+	ofxClutterTexture* takeTexture(string path);
+	
+	// Throughput.  Decode MB/s counts decoded pixel data, summed over all
+	// workers and divided by wall time, so it grows with the thread count.
+	float getDecodeMBPerSecond();
+	int getUploadsLastFrame() { return uploadsLastFrame; }
+	float getUploadsPerFrame() { return numFrames ? (float)numFinished / numFrames : 0; }
+	float getUploadMillis() { return uploadMillis; }
+	float getWallMillis();
+	string getReport();
+	
+	// Called by the decode jobs
+	void imageDecoded(string path, ofImage& img, bool success, float decodeMillis);
+	
+protected:
+	void queueImages();
+	int getInFlightLimit();
+	
+	vector<string> paths;
+	int numQueued;
+	map<string, ofxClutterTexture*> textures;
+	ofxClutterWorkerPool* pool;
+	
+	bool started;
+	int numThreads;
+	int uploadBudget;
+	int maxInFlight;
+	int numFinished;
+	int numFailed;
+	int numFrames;
+	int uploadsLastFrame;
+	double decodedBytes;
+	float decodeMillis;
+	float uploadMillis;
+	int startTime;
+	int endTime;
+};
@@ -0,0 +1,378 @@
+/*
+ *  ofxClutterReconciler.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterReconciler.h"
+#include "ofxClutterColor.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+//------------------------------------------------------------
+bool ofxClutterNodeValue::sameProperty(const ofxClutterNodeValue& other) const {
+	return property == other.property && (property != OFX_CLUTTER_SCENE_GENERIC || name == other.name);
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterNodeValue::operator==(const ofxClutterNodeValue& other) const {
+	if(!sameProperty(other) || kind != other.kind) return false;
+	switch(kind) {
+		case NUMBER:	return number == other.number;
+		case STRING:	return str == other.str;
+		case COLOR:		return clutter_color_equal(&color, &other.color);
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode::ofxClutterNode(ofxClutterSceneType type, string key) {
+	this->type = type;
+	this->key = key;
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode ofxClutterNode::text(string key, string str, string font) {
+	ofxClutterNode node(OFX_CLUTTER_SCENE_TEXT, key);
+	node.set(OFX_CLUTTER_SCENE_FONT_NAME, font);
+	node.set(OFX_CLUTTER_SCENE_TEXT_STRING, str);
+	return node;
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode ofxClutterNode::texture(string key, string filename) {
+	ofxClutterNode node(OFX_CLUTTER_SCENE_TEXTURE, key);
+	node.set(OFX_CLUTTER_SCENE_FILENAME, filename);
+	return node;
+}
+
+
+//------------------------------------------------------------
+// Setting a property twice keeps the last value
+ofxClutterNode& ofxClutterNode::set(const ofxClutterNodeValue& value) {
+	for(int i=0; i<values.size(); i++) {
+		if(values[i].sameProperty(value)) {
+			values[i] = value;
+			return *this;
+		}
+	}
+	values.push_back(value);
+	return *this;
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::set(ofxClutterSceneProperty property, float number) {
+	ofxClutterNodeValue value;
+	value.property = property;
+	value.kind = ofxClutterNodeValue::NUMBER;
+	value.number = number;
+	return set(value);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::set(ofxClutterSceneProperty property, string str) {
+	ofxClutterNodeValue value;
+	value.property = property;
+	value.kind = ofxClutterNodeValue::STRING;
+	value.str = str;
+	return set(value);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::set(ofxClutterSceneProperty property, ClutterColor color) {
+	ofxClutterNodeValue value;
+	value.property = property;
+	value.kind = ofxClutterNodeValue::COLOR;
+	value.color = color;
+	return set(value);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::set(string name, float number) {
+	ofxClutterNodeValue value;
+	value.property = ofxClutterScene::findProperty(name.c_str());
+	value.name = name;
+	value.kind = ofxClutterNodeValue::NUMBER;
+	value.number = number;
+	return set(value);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::set(string name, string str) {
+	ofxClutterNodeValue value;
+	value.property = ofxClutterScene::findProperty(name.c_str());
+	value.name = name;
+	value.kind = ofxClutterNodeValue::STRING;
+	value.str = str;
+	return set(value);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::color(int r, int g, int b, int a) {
+	ClutterColor col = { r, g, b, a };
+	return set(OFX_CLUTTER_SCENE_COLOR, col);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::color(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterNode: " + color + " isn't a color");
+		return *this;
+	}
+	return set(OFX_CLUTTER_SCENE_COLOR, col);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::border(int r, int g, int b, int a, int width) {
+	ClutterColor col = { r, g, b, a };
+	return set(OFX_CLUTTER_SCENE_BORDER_COLOR, col).set(OFX_CLUTTER_SCENE_BORDER_WIDTH, (float)width);
+}
+
+
+//------------------------------------------------------------
+ofxClutterNode& ofxClutterNode::add(const ofxClutterNode& child) {
+	children.push_back(child);
+	return children.back();
+}
+
+
+//------------------------------------------------------------
+ofxClutterReconciler::ofxClutterReconciler() {
+	root = NULL;
+	numCreated = numDestroyed = numMoved = numPropertiesSet = 0;
+	renderMillis = 0;
+}
+
+
+//------------------------------------------------------------
+ofxClutterReconciler::~ofxClutterReconciler() {
+	clear();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::clear() {
+	if(root) unmount(root);
+	root = NULL;
+}
+
+
+//------------------------------------------------------------
+ClutterActor* ofxClutterReconciler::getRootActor() {
+	return root ? root->actor : NULL;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::render(const ofxClutterNode& node) {
+	GTimer* timer = g_timer_new();
+	numCreated = numDestroyed = numMoved = numPropertiesSet = 0;
+	
+	if(root && root->type != node.type) {
+		unmount(root);
+		root = NULL;
+	}
+	if(root) update(root, node);
+	else root = mount(node, node.key, stage);
+	
+	renderMillis = g_timer_elapsed(timer, NULL) * 1000;
+	g_timer_destroy(timer);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::apply(ClutterActor* actor, const ofxClutterNodeValue& value) {
+	const char* name = (value.property == OFX_CLUTTER_SCENE_GENERIC) ? value.name.c_str()
+						: ofxClutterScene::getPropertyName(value.property);
+	GValue v = { 0 };
+	switch(value.kind) {
+		case ofxClutterNodeValue::NUMBER:
+			g_value_init(&v, G_TYPE_FLOAT);
+			g_value_set_float(&v, value.number);
+			break;
+		case ofxClutterNodeValue::STRING:
+			g_value_init(&v, G_TYPE_STRING);
+			g_value_set_static_string(&v, value.str.c_str());
+			break;
+		case ofxClutterNodeValue::COLOR:
+			g_value_init(&v, CLUTTER_TYPE_COLOR);
+			g_value_set_static_boxed(&v, &value.color);
+			break;
+	}
+	ofxClutterScene::setProperty(actor, value.property, name, &v);
+	g_value_unset(&v);
+	numPropertiesSet++;
+}
+
+
+//------------------------------------------------------------
+ofxClutterReconciler::Instance* ofxClutterReconciler::mount(const ofxClutterNode& node, const string& key, ClutterActor* parent) {
+	ofxClutterSceneType type = node.type;
+	if(type == OFX_CLUTTER_SCENE_STAGE || type == OFX_CLUTTER_SCENE_OTHER || type >= OFX_CLUTTER_SCENE_NUM_TYPES) {
+		ofLog(OF_LOG_ERROR, "ofxClutterReconciler: " + key + " has no actor type, using a group");
+		type = OFX_CLUTTER_SCENE_GROUP;
+	}
+	
+	Instance* instance = new Instance();
+	instance->actor = CLUTTER_ACTOR(g_object_ref_sink(ofxClutterScene::createActor(type, "")));
+	instance->type = node.type;
+	instance->key = key;
+	instance->values = node.values;
+	clutter_container_add_actor(CLUTTER_CONTAINER(parent), instance->actor);
+	clutter_actor_show(instance->actor);
+	numCreated++;
+	
+	for(int i=0; i<node.values.size(); i++) {
+		apply(instance->actor, node.values[i]);
+	}
+	updateChildren(instance, node);
+	return instance;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::unmount(Instance* instance) {
+	// Destroying the actor takes the children's actors with it
+	if(clutter_actor_get_parent(instance->actor)) clutter_actor_destroy(instance->actor);
+	g_object_unref(instance->actor);
+	numDestroyed++;
+	
+	for(int i=0; i<instance->children.size(); i++) {
+		unmount(instance->children[i]);
+	}
+	delete instance;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::update(Instance* instance, const ofxClutterNode& node) {
+	for(int i=0; i<node.values.size(); i++) {
+		const ofxClutterNodeValue& value = node.values[i];
+		bool same = false;
+		for(int j=0; j<instance->values.size(); j++) {
+			if(instance->values[j].sameProperty(value)) {
+				same = (instance->values[j] == value);
+				break;
+			}
+		}
+		if(!same) apply(instance->actor, value);
+	}
+	
+	// Dropped from the description: back to the default
+	for(int j=0; j<instance->values.size(); j++) {
+		const ofxClutterNodeValue& old = instance->values[j];
+		bool kept = false;
+		for(int i=0; i<node.values.size() && !kept; i++) {
+			kept = node.values[i].sameProperty(old);
+		}
+		if(kept) continue;
+		const char* name = (old.property == OFX_CLUTTER_SCENE_GENERIC) ? old.name.c_str()
+							: ofxClutterScene::getPropertyName(old.property);
+		ofxClutterScene::resetProperty(instance->actor, old.property, name);
+		numPropertiesSet++;
+	}
+	
+	instance->values = node.values;
+	updateChildren(instance, node);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterReconciler::updateChildren(Instance* instance, const ofxClutterNode& node) {
+	if(node.children.empty() && instance->children.empty()) return;
+	if(!CLUTTER_IS_CONTAINER(instance->actor)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterReconciler: " + instance->key + " can't have children");
+		return;
+	}
+	
+	// Keys of the new children; unkeyed and repeated ones go by position
+	int n = node.children.size();
+	vector<string> keys(n);
+	set<string> seen;
+	for(int i=0; i<n; i++) {
+		keys[i] = node.children[i].key;
+		if(!keys[i].empty() && seen.count(keys[i])) {
+			ofLog(OF_LOG_WARNING, "ofxClutterReconciler: key " + keys[i] + " is used twice under " + instance->key);
+			keys[i] = "";
+		}
+		if(keys[i].empty()) keys[i] = "#" + ofToString(i);
+		seen.insert(keys[i]);
+	}
+	
+	map<string, int> oldIndex;
+	for(int i=0; i<instance->children.size(); i++) {
+		oldIndex[instance->children[i]->key] = i;
+	}
+	
+	// Match, update or create
+	vector<Instance*> children(n, (Instance*)NULL);
+	vector<int> previous(n, -1);		// old position, -1 if created
+	vector<bool> reused(instance->children.size(), false);
+	for(int i=0; i<n; i++) {
+		map<string, int>::iterator it = oldIndex.find(keys[i]);
+		if(it != oldIndex.end() && instance->children[it->second]->type == node.children[i].type) {
+			children[i] = instance->children[it->second];
+			previous[i] = it->second;
+			reused[it->second] = true;
+			update(children[i], node.children[i]);
+		}
+		else {
+			children[i] = mount(node.children[i], keys[i], instance->actor);
+		}
+	}
+	for(int i=0; i<instance->children.size(); i++) {
+		if(!reused[i]) unmount(instance->children[i]);
+	}
+	
+	// The longest run of kept children already in order stays put
+	// (longest increasing subsequence of their old positions)
+	vector<bool> stays(n, false);
+	vector<int> tails, tailIndex, parent(n, -1);
+	for(int i=0; i<n; i++) {
+		if(previous[i] < 0) continue;
+		int pos = lower_bound(tails.begin(), tails.end(), previous[i]) - tails.begin();
+		if(pos == tails.size()) {
+			tails.push_back(previous[i]);
+			tailIndex.push_back(i);
+		}
+		else {
+			tails[pos] = previous[i];
+			tailIndex[pos] = i;
+		}
+		parent[i] = (pos > 0) ? tailIndex[pos - 1] : -1;
+	}
+	for(int i = tailIndex.empty() ? -1 : tailIndex.back(); i >= 0; i = parent[i]) {
+		stays[i] = true;
+	}
+	
+	// New children after the last kept one were added on top, in order
+	int tail = n;
+	while(tail > 0 && previous[tail - 1] < 0) tail--;
+	
+	// Everything else goes right above the child before it
+	for(int i=0; i<n; i++) {
+		if(stays[i] || i >= tail) continue;
+		if(i == 0) clutter_actor_lower_bottom(children[i]->actor);
+		else clutter_actor_raise(children[i]->actor, children[i-1]->actor);
+		if(previous[i] >= 0) numMoved++;
+	}
+	
+	instance->children = children;
+}
@@ -0,0 +1,111 @@
+/*
+ *  ofxClutterReconciler.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterScene.h"
+
+// One property value in an ofxClutterNode
+struct ofxClutterNodeValue {
+	enum Kind { NUMBER, STRING, COLOR };
+	
+	ofxClutterSceneProperty property;
+	string name;			// for OFX_CLUTTER_SCENE_GENERIC
+	Kind kind;
+	float number;
+	string str;
+	ClutterColor color;
+	
+	bool sameProperty(const ofxClutterNodeValue& other) const;
+	bool operator==(const ofxClutterNodeValue& other) const;
+};
+
+
+// A description of one actor and its children: plain values, cheap to
+// build from scratch every frame.  Children are matched to the previous
+// description by key, so give every child in a list a key that stays
+// with the item it shows (an id, not its index).  Children without a key
+// are matched by position.
+class ofxClutterNode {
+public:
+	ofxClutterNode(ofxClutterSceneType type=OFX_CLUTTER_SCENE_GROUP, string key="");
+	
+	static ofxClutterNode group(string key="") { return ofxClutterNode(OFX_CLUTTER_SCENE_GROUP, key); }
+	static ofxClutterNode rect(string key="") { return ofxClutterNode(OFX_CLUTTER_SCENE_RECTANGLE, key); }
+	static ofxClutterNode text(string key, string str, string font="Sans 12");
+	static ofxClutterNode texture(string key, string filename);
+	
+	ofxClutterNode& set(ofxClutterSceneProperty property, float value);
+	ofxClutterNode& set(ofxClutterSceneProperty property, string value);
+	ofxClutterNode& set(ofxClutterSceneProperty property, ClutterColor value);
+	ofxClutterNode& set(string name, float value);		// any other property, by name
+	ofxClutterNode& set(string name, string value);
+	
+	ofxClutterNode& position(float x, float y) { return set(OFX_CLUTTER_SCENE_X, x).set(OFX_CLUTTER_SCENE_Y, y); }
+	ofxClutterNode& size(float w, float h) { return set(OFX_CLUTTER_SCENE_WIDTH, w).set(OFX_CLUTTER_SCENE_HEIGHT, h); }
+	ofxClutterNode& anchor(float x, float y) { return set(OFX_CLUTTER_SCENE_ANCHOR_X, x).set(OFX_CLUTTER_SCENE_ANCHOR_Y, y); }
+	ofxClutterNode& rotation(float degrees) { return set(OFX_CLUTTER_SCENE_ROTATION_Z, degrees); }
+	ofxClutterNode& opacity(int opacity) { return set(OFX_CLUTTER_SCENE_OPACITY, (float)opacity); }
+	ofxClutterNode& color(int r, int g, int b, int a=255);
+	ofxClutterNode& color(const string& color);		// CSS/X11 name or #rrggbb[aa]
+	ofxClutterNode& border(int r, int g, int b, int a, int width);
+	
+	// Adds a copy of child.  The reference is to the copy, for adding its
+	// own children, and is good until the next add() on this node.
+	ofxClutterNode& add(const ofxClutterNode& child);
+	
+	ofxClutterSceneType type;
+	string key;
+	vector<ofxClutterNodeValue> values;
+	vector<ofxClutterNode> children;
+	
+protected:
+	ofxClutterNode& set(const ofxClutterNodeValue& value);
+};
+
+
+// Keeps the stage in line with a description.  Call render() with a new
+// ofxClutterNode tree whenever the data changes, or every frame; it is
+// compared with the last one and only the differences become Clutter
+// calls: actors created and destroyed, properties set, and children
+// restacked with as few moves as possible (everything outside the longest
+// run already in order).  The root actor is added to the stage.
+class ofxClutterReconciler {
+public:
+	ofxClutterReconciler();
+	~ofxClutterReconciler();
+	
+	void render(const ofxClutterNode& root);
+	void clear();		// destroys the actors
+	
+	ClutterActor* getRootActor();
+	
+	// What the last render() did; per frame when it is called once a frame
+	int getNumPatches() { return numCreated + numDestroyed + numMoved + numPropertiesSet; }
+	int getNumCreated() { return numCreated; }
+	int getNumDestroyed() { return numDestroyed; }
+	int getNumMoved() { return numMoved; }
+	int getNumPropertiesSet() { return numPropertiesSet; }
+	float getRenderMillis() { return renderMillis; }
+	
+protected:
+	struct Instance {
+		ClutterActor* actor;		// referenced
+		ofxClutterSceneType type;
+		string key;
+		vector<ofxClutterNodeValue> values;
+		vector<Instance*> children;
+	};
+	
+	Instance* mount(const ofxClutterNode& node, const string& key, ClutterActor* parent);
+	void unmount(Instance* instance);
+	void update(Instance* instance, const ofxClutterNode& node);
+	void updateChildren(Instance* instance, const ofxClutterNode& node);
+	void apply(ClutterActor* actor, const ofxClutterNodeValue& value);
+	
+	Instance* root;
+	int numCreated, numDestroyed, numMoved, numPropertiesSet;
+	float renderMillis;
+};
@@ -20,4 +20,15 @@ ofxClutterRect::ofxClutterRect() {
 	actor = clutter_rectangle_new();
 	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
 	clutter_actor_show(actor);
-}
\ No newline at end of file
+}
+
+
+//------------------------------------------------------------
+void ofxClutterRect::setColor(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterRect: unknown color " + color);
+		return;
+	}
+	clutter_rectangle_set_color(CLUTTER_RECTANGLE(actor), &col);
+}
@@ -9,6 +9,7 @@
 
 #pragma once
 #include "ofxClutterActor.h"
+#include "ofxClutterColor.h"
 
 
 
@@ -32,16 +33,8 @@ public:
 		clutter_rectangle_set_color(CLUTTER_RECTANGLE(actor), &col);
 	}
 	
-	void setColor(string color) {
-		/*
-		 ClutterColor red = { 255, 0, 0, 128 };
-		 ClutterColor green = { 0, 255, 0, 128 };
-		 ClutterColor blue = { 0, 0, 255, 128 };
-		 ClutterColor yellow = { 255, 255, 0, 128 };
-		 ClutterColor cyan = { 0, 255, 255, 128 };
-		 ClutterColor purple = { 255, 0, 255, 128 };	
-		 */
-	}
+	// CSS/X11 name or #rrggbb[aa], see ofxClutterColor
+	void setColor(const string& color);
 	
 	void setBorder(int r, int g, int b, int a, int w) {
 		ClutterColor col = {r, g, b, a};
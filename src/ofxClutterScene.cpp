@@ -0,0 +1,929 @@
+/*
+ *  ofxClutterScene.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterScene.h"
+#include "ofxClutterColor.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <gmodule.h>
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+// Layout of a scene file: this header, then the nodes, the property
+// records, the id index, the string offsets and the string bytes, each
+// section right after the one before.  String 0 is "".
+static const char sceneMagic[8] = { 'o', 'f', 'x', 's', 'c', 'n', '0', '1' };
+
+struct ofxClutterSceneHeader {
+	char magic[8];
+	guint32 numNodes;
+	guint32 numRecords;
+	guint32 numIds;
+	guint32 numStrings;
+	guint32 stringBytes;
+	guint32 reserved;
+};
+
+struct ofxClutterSceneNode {
+	guint16 type;			// ofxClutterSceneType
+	guint16 reserved;
+	guint32 typeName;		// string, for OFX_CLUTTER_SCENE_OTHER
+	guint32 id;				// string
+	gint32 parent;			// earlier node, or -1
+	guint32 firstRecord;
+	guint32 numRecords;
+};
+
+enum {
+	RECORD_INT,
+	RECORD_FLOAT,
+	RECORD_BOOL,
+	RECORD_STRING,
+	RECORD_COLOR
+};
+
+struct ofxClutterSceneRecord {
+	guint16 property;		// ofxClutterSceneProperty
+	guint16 kind;
+	guint32 name;			// string, for OFX_CLUTTER_SCENE_GENERIC and messages
+	union {
+		gint32 i;
+		gfloat f;
+		guint32 string;
+		guint32 rgba;
+	} value;
+};
+
+
+static const char* typeNames[OFX_CLUTTER_SCENE_NUM_TYPES] = {
+	"", "ClutterStage", "ClutterGroup", "ClutterRectangle", "ClutterText", "ClutterTexture"
+};
+
+static const char* propertyNames[OFX_CLUTTER_SCENE_NUM_PROPERTIES] = {
+	"", "x", "y", "width", "height", "depth", "opacity", "visible", "reactive", "name",
+	"scale-x", "scale-y", "rotation-angle-z", "anchor-x", "anchor-y",
+	"color", "border-color", "border-width", "text", "font-name", "use-markup", "filename"
+};
+
+
+//------------------------------------------------------------
+ofxClutterScene::ofxClutterScene() {
+	mapped = NULL;
+	mappedSize = 0;
+	numNodes = 0;
+	loadMillis = 0;
+}
+
+
+//------------------------------------------------------------
+ofxClutterScene::~ofxClutterScene() {
+	clear();
+}
+
+
+//------------------------------------------------------------
+ofxClutterSceneType ofxClutterScene::findType(const char* name) {
+	for(int i=1; i<OFX_CLUTTER_SCENE_NUM_TYPES; i++) {
+		if(strcmp(name, typeNames[i]) == 0) return (ofxClutterSceneType)i;
+	}
+	return OFX_CLUTTER_SCENE_OTHER;
+}
+
+
+//------------------------------------------------------------
+ofxClutterSceneProperty ofxClutterScene::findProperty(const char* name) {
+	for(int i=1; i<OFX_CLUTTER_SCENE_NUM_PROPERTIES; i++) {
+		if(strcmp(name, propertyNames[i]) == 0) return (ofxClutterSceneProperty)i;
+	}
+	return OFX_CLUTTER_SCENE_GENERIC;
+}
+
+
+//------------------------------------------------------------
+ClutterActor* ofxClutterScene::createActor(ofxClutterSceneType type, const char* typeName) {
+	switch(type) {
+		case OFX_CLUTTER_SCENE_STAGE:		return stage;
+		case OFX_CLUTTER_SCENE_GROUP:		return clutter_group_new();
+		case OFX_CLUTTER_SCENE_RECTANGLE:	return clutter_rectangle_new();
+		case OFX_CLUTTER_SCENE_TEXT:		return clutter_text_new();
+		case OFX_CLUTTER_SCENE_TEXTURE:		return clutter_texture_new();
+		default: break;
+	}
+	
+	GType gtype = resolveType(typeName);
+	if(gtype == 0 || !g_type_is_a(gtype, CLUTTER_TYPE_ACTOR) || G_TYPE_IS_ABSTRACT(gtype)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: " + string(typeName) + " isn't a registered actor type");
+		return NULL;
+	}
+	return CLUTTER_ACTOR(g_object_new(gtype, NULL));
+}
+
+
+//------------------------------------------------------------
+// Types are registered the first time their _get_type() runs, so a type
+// nothing has used yet has no name.  The function name is made from the
+// type name as ClutterScript makes it: an underscore before each capital
+// that follows a lower case letter, or that follows two capitals.
+GType ofxClutterScene::resolveType(const char* name) {
+	GType gtype = g_type_from_name(name);
+	if(gtype != 0) return gtype;
+	
+	string symbol;
+	for(int i=0; name[i]; i++) {
+		char c = name[i];
+		bool upper = g_ascii_isupper(c);
+		if((upper && i > 0 && !g_ascii_isupper(name[i-1]))
+		   || (upper && i > 2 && g_ascii_isupper(name[i-1]) && g_ascii_isupper(name[i-2]))) {
+			symbol += '_';
+		}
+		symbol += g_ascii_tolower(c);
+	}
+	symbol += "_get_type";
+	
+	static GModule* module = NULL;
+	if(module == NULL) module = g_module_open(NULL, (GModuleFlags)0);
+	typedef GType (*GetTypeFunc)(void);
+	GetTypeFunc func;
+	if(module && g_module_symbol(module, symbol.c_str(), (gpointer*)&func)) {
+		return func();
+	}
+	return 0;
+}
+
+
+//------------------------------------------------------------
+static bool getFloat(const GValue* value, float& out) {
+	switch(G_VALUE_TYPE(value)) {
+		case G_TYPE_FLOAT:		out = g_value_get_float(value); return true;
+		case G_TYPE_DOUBLE:		out = g_value_get_double(value); return true;
+		case G_TYPE_INT:		out = g_value_get_int(value); return true;
+		case G_TYPE_INT64:		out = g_value_get_int64(value); return true;
+		case G_TYPE_UINT:		out = g_value_get_uint(value); return true;
+		case G_TYPE_UCHAR:		out = g_value_get_uchar(value); return true;
+		case G_TYPE_BOOLEAN:	out = g_value_get_boolean(value); return true;
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+static bool getColor(const GValue* value, ClutterColor& out) {
+	if(CLUTTER_VALUE_HOLDS_COLOR(value)) {
+		const ClutterColor* color = clutter_value_get_color(value);
+		if(color == NULL) return false;
+		out = *color;
+		return true;
+	}
+	if(G_VALUE_HOLDS_STRING(value)) {
+		const char* str = g_value_get_string(value);
+		return str != NULL && ofxClutterColor::parse(str, out);
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+// Anything without a setter of its own: by name, converting strings to
+// colors and enums the way ClutterScript does
+static bool setByName(ClutterActor* actor, const char* name, const GValue* value) {
+	GParamSpec* pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(actor), name);
+	if(pspec == NULL || !(pspec->flags & G_PARAM_WRITABLE)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: " + string(G_OBJECT_TYPE_NAME(actor)) + " has no property " + name);
+		return false;
+	}
+	
+	GType type = G_PARAM_SPEC_VALUE_TYPE(pspec);
+	if(G_VALUE_TYPE(value) == type) {
+		g_object_set_property(G_OBJECT(actor), name, value);
+		return true;
+	}
+	
+	GValue converted = { 0 };
+	g_value_init(&converted, type);
+	bool success = false;
+	if(type == CLUTTER_TYPE_COLOR) {
+		ClutterColor color;
+		if((success = getColor(value, color))) clutter_value_set_color(&converted, &color);
+	}
+	else if(G_VALUE_HOLDS_STRING(value) && (G_TYPE_IS_ENUM(type) || G_TYPE_IS_FLAGS(type))) {
+		const char* str = g_value_get_string(value);
+		gpointer klass = g_type_class_ref(type);
+		if(G_TYPE_IS_ENUM(type)) {
+			GEnumValue* e = g_enum_get_value_by_name(G_ENUM_CLASS(klass), str);
+			if(e == NULL) e = g_enum_get_value_by_nick(G_ENUM_CLASS(klass), str);
+			if((success = (e != NULL))) g_value_set_enum(&converted, e->value);
+		}
+		else {
+			GFlagsValue* f = g_flags_get_value_by_name(G_FLAGS_CLASS(klass), str);
+			if(f == NULL) f = g_flags_get_value_by_nick(G_FLAGS_CLASS(klass), str);
+			if((success = (f != NULL))) g_value_set_flags(&converted, f->value);
+		}
+		g_type_class_unref(klass);
+	}
+	else if(g_value_type_transformable(G_VALUE_TYPE(value), type)) {
+		success = g_value_transform(value, &converted);
+	}
+	
+	if(success) {
+		g_object_set_property(G_OBJECT(actor), name, &converted);
+	}
+	else {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: can't set " + string(name) + " (" + g_type_name(type)
+			  + ") from a " + g_type_name(G_VALUE_TYPE(value)));
+	}
+	g_value_unset(&converted);
+	return success;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterScene::setProperty(ClutterActor* actor, ofxClutterSceneProperty property, const char* name, const GValue* value) {
+	float f;
+	ClutterColor color;
+	
+	switch(property) {
+		case OFX_CLUTTER_SCENE_X:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_x(actor, f);
+			return true;
+		case OFX_CLUTTER_SCENE_Y:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_y(actor, f);
+			return true;
+		case OFX_CLUTTER_SCENE_WIDTH:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_width(actor, f);
+			return true;
+		case OFX_CLUTTER_SCENE_HEIGHT:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_height(actor, f);
+			return true;
+		case OFX_CLUTTER_SCENE_DEPTH:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_depth(actor, f);
+			return true;
+		case OFX_CLUTTER_SCENE_OPACITY:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_opacity(actor, CLAMP(f, 0, 255));
+			return true;
+		case OFX_CLUTTER_SCENE_VISIBLE:
+			if(!getFloat(value, f)) break;
+			if(f != 0) clutter_actor_show(actor);
+			else clutter_actor_hide(actor);
+			return true;
+		case OFX_CLUTTER_SCENE_REACTIVE:
+			if(!getFloat(value, f)) break;
+			clutter_actor_set_reactive(actor, f != 0);
+			return true;
+		case OFX_CLUTTER_SCENE_NAME:
+			if(!G_VALUE_HOLDS_STRING(value)) break;
+			clutter_actor_set_name(actor, g_value_get_string(value));
+			return true;
+		case OFX_CLUTTER_SCENE_SCALE_X:
+		case OFX_CLUTTER_SCENE_SCALE_Y: {
+			if(!getFloat(value, f)) break;
+			gdouble sx, sy;
+			clutter_actor_get_scale(actor, &sx, &sy);
+			if(property == OFX_CLUTTER_SCENE_SCALE_X) sx = f;
+			else sy = f;
+			clutter_actor_set_scale(actor, sx, sy);
+			return true;
+		}
+		case OFX_CLUTTER_SCENE_ROTATION_Z: {
+			if(!getFloat(value, f)) break;
+			gfloat cx, cy, cz;
+			clutter_actor_get_rotation(actor, CLUTTER_Z_AXIS, &cx, &cy, &cz);
+			clutter_actor_set_rotation(actor, CLUTTER_Z_AXIS, f, cx, cy, cz);
+			return true;
+		}
+		case OFX_CLUTTER_SCENE_ANCHOR_X:
+		case OFX_CLUTTER_SCENE_ANCHOR_Y: {
+			if(!getFloat(value, f)) break;
+			gfloat ax, ay;
+			clutter_actor_get_anchor_point(actor, &ax, &ay);
+			if(property == OFX_CLUTTER_SCENE_ANCHOR_X) ax = f;
+			else ay = f;
+			clutter_actor_set_anchor_point(actor, ax, ay);
+			return true;
+		}
+		case OFX_CLUTTER_SCENE_COLOR:
+			if(!getColor(value, color)) break;
+			if(CLUTTER_IS_RECTANGLE(actor)) clutter_rectangle_set_color(CLUTTER_RECTANGLE(actor), &color);
+			else if(CLUTTER_IS_TEXT(actor)) clutter_text_set_color(CLUTTER_TEXT(actor), &color);
+			else if(CLUTTER_IS_STAGE(actor)) clutter_stage_set_color(CLUTTER_STAGE(actor), &color);
+			else break;
+			return true;
+		case OFX_CLUTTER_SCENE_BORDER_COLOR:
+			if(!CLUTTER_IS_RECTANGLE(actor) || !getColor(value, color)) break;
+			clutter_rectangle_set_border_color(CLUTTER_RECTANGLE(actor), &color);
+			return true;
+		case OFX_CLUTTER_SCENE_BORDER_WIDTH:
+			if(!CLUTTER_IS_RECTANGLE(actor) || !getFloat(value, f)) break;
+			clutter_rectangle_set_border_width(CLUTTER_RECTANGLE(actor), f);
+			return true;
+		case OFX_CLUTTER_SCENE_TEXT_STRING:
+			if(!CLUTTER_IS_TEXT(actor) || !G_VALUE_HOLDS_STRING(value)) break;
+			clutter_text_set_text(CLUTTER_TEXT(actor), g_value_get_string(value));
+			return true;
+		case OFX_CLUTTER_SCENE_FONT_NAME:
+			if(!CLUTTER_IS_TEXT(actor) || !G_VALUE_HOLDS_STRING(value)) break;
+			clutter_text_set_font_name(CLUTTER_TEXT(actor), g_value_get_string(value));
+			return true;
+		case OFX_CLUTTER_SCENE_USE_MARKUP:
+			if(!CLUTTER_IS_TEXT(actor) || !getFloat(value, f)) break;
+			clutter_text_set_use_markup(CLUTTER_TEXT(actor), f != 0);
+			return true;
+		case OFX_CLUTTER_SCENE_FILENAME: {
+			if(!CLUTTER_IS_TEXTURE(actor) || !G_VALUE_HOLDS_STRING(value)) break;
+			// Relative paths are relative to the data folder, like ofImage
+			string path = ofToDataPath(g_value_get_string(value));
+			GError* error = NULL;
+			if(!clutter_texture_set_from_file(CLUTTER_TEXTURE(actor), path.c_str(), &error)) {
+				ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't load " + path);
+				fprintf(stderr, "%s\n", error->message);
+				g_error_free(error);
+				return false;
+			}
+			return true;
+		}
+		default:
+			break;
+	}
+	return setByName(actor, name, value);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterScene::resetProperty(ClutterActor* actor, ofxClutterSceneProperty property, const char* name) {
+	switch(property) {
+		case OFX_CLUTTER_SCENE_WIDTH:	clutter_actor_set_width(actor, -1); return;
+		case OFX_CLUTTER_SCENE_HEIGHT:	clutter_actor_set_height(actor, -1); return;
+		case OFX_CLUTTER_SCENE_VISIBLE:	clutter_actor_show(actor); return;
+		default: break;
+	}
+	
+	GParamSpec* pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(actor), name);
+	if(pspec == NULL || !(pspec->flags & G_PARAM_WRITABLE) || (pspec->flags & G_PARAM_CONSTRUCT_ONLY)) return;
+	GValue value = { 0 };
+	g_value_init(&value, G_PARAM_SPEC_VALUE_TYPE(pspec));
+	g_param_value_set_default(pspec, &value);
+	g_object_set_property(G_OBJECT(actor), name, &value);
+	g_value_unset(&value);
+}
+
+
+//------------------------------------------------------------
+const char* ofxClutterScene::getPropertyName(ofxClutterSceneProperty property) {
+	if(property < 0 || property >= OFX_CLUTTER_SCENE_NUM_PROPERTIES) return "";
+	return propertyNames[property];
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterScene::readValue(JsonNode* node, ofxClutterSceneProperty property, GValue* value) {
+	if(property == OFX_CLUTTER_SCENE_COLOR || property == OFX_CLUTTER_SCENE_BORDER_COLOR) {
+		ClutterColor color = { 0, 0, 0, 255 };
+		bool parsed = false;
+		if(JSON_NODE_TYPE(node) == JSON_NODE_VALUE && json_node_get_value_type(node) == G_TYPE_STRING) {
+			parsed = ofxClutterColor::parse(json_node_get_string(node), color);
+		}
+		else if(JSON_NODE_TYPE(node) == JSON_NODE_ARRAY) {
+			// [ red, green, blue, alpha ], alpha optional
+			JsonArray* array = json_node_get_array(node);
+			int n = json_array_get_length(array);
+			if(n == 3 || n == 4) {
+				guint8* channels = &color.red;
+				for(int i=0; i<n; i++) {
+					channels[i] = CLAMP(json_node_get_int(json_array_get_element(array, i)), 0, 255);
+				}
+				parsed = true;
+			}
+		}
+		if(!parsed) return false;
+		g_value_init(value, CLUTTER_TYPE_COLOR);
+		clutter_value_set_color(value, &color);
+		return true;
+	}
+	
+	if(JSON_NODE_TYPE(node) != JSON_NODE_VALUE) return false;
+	GType type = json_node_get_value_type(node);
+	if(type == G_TYPE_INT64) {
+		g_value_init(value, G_TYPE_INT);
+		g_value_set_int(value, json_node_get_int(node));
+	}
+	else if(type == G_TYPE_DOUBLE) {
+		g_value_init(value, G_TYPE_FLOAT);
+		g_value_set_float(value, json_node_get_double(node));
+	}
+	else if(type == G_TYPE_BOOLEAN) {
+		g_value_init(value, G_TYPE_BOOLEAN);
+		g_value_set_boolean(value, json_node_get_boolean(node));
+	}
+	else if(type == G_TYPE_STRING) {
+		g_value_init(value, G_TYPE_STRING);
+		g_value_set_string(value, json_node_get_string(node));
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------
+// Conversion
+//------------------------------------------------------------
+namespace {
+	struct Definition {
+		JsonObject* object;
+		string id;
+		string type;
+		int parent;
+		vector<int> children;	// definitions, or -1 - reference for a child given by id
+	};
+	
+	struct Converter {
+		vector<Definition> definitions;
+		vector<string> references;
+		
+		vector<ofxClutterSceneNode> nodes;
+		vector<ofxClutterSceneRecord> records;
+		vector<string> strings;
+		map<string, guint32> interned;
+		
+		guint32 intern(const string& str) {
+			map<string, guint32>::iterator it = interned.find(str);
+			if(it != interned.end()) return it->second;
+			guint32 index = strings.size();
+			strings.push_back(str);
+			interned[str] = index;
+			return index;
+		}
+		
+		int collect(JsonObject* object, int parent);
+		void emit(int definition, int parent);
+		void addRecord(const char* name, JsonNode* node, const string& owner);
+	};
+	
+	// Members that are structure rather than properties
+	bool isStructural(const char* name) {
+		return strcmp(name, "id") == 0 || strcmp(name, "type") == 0 || strcmp(name, "children") == 0;
+	}
+	
+	// Set before the rest, since they can resize the actor
+	bool isContent(ofxClutterSceneProperty property) {
+		return property == OFX_CLUTTER_SCENE_TEXT_STRING || property == OFX_CLUTTER_SCENE_FONT_NAME
+			|| property == OFX_CLUTTER_SCENE_USE_MARKUP || property == OFX_CLUTTER_SCENE_FILENAME;
+	}
+}
+
+
+//------------------------------------------------------------
+int Converter::collect(JsonObject* object, int parent) {
+	const char* id = json_object_has_member(object, "id") ? json_object_get_string_member(object, "id") : NULL;
+	const char* type = json_object_has_member(object, "type") ? json_object_get_string_member(object, "type") : NULL;
+	if(type == NULL) {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: skipping object " + string(id ? id : "") + " without a type");
+		return -1;
+	}
+	GType gtype = ofxClutterScene::resolveType(type);
+	if(gtype == 0) {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: skipping " + string(type) + " " + string(id ? id : "") + ", unknown type");
+		return -1;
+	}
+	if(!g_type_is_a(gtype, CLUTTER_TYPE_ACTOR)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: skipping " + string(type) + " " + string(id ? id : "") + ", only actors are converted");
+		return -1;
+	}
+	
+	int index = definitions.size();
+	definitions.push_back(Definition());
+	definitions[index].object = object;
+	definitions[index].id = id ? id : "";
+	definitions[index].type = type;
+	definitions[index].parent = parent;
+	
+	if(json_object_has_member(object, "children")) {
+		JsonNode* children = json_object_get_member(object, "children");
+		if(JSON_NODE_TYPE(children) == JSON_NODE_ARRAY) {
+			JsonArray* array = json_node_get_array(children);
+			for(int i=0; i<json_array_get_length(array); i++) {
+				JsonNode* child = json_array_get_element(array, i);
+				if(JSON_NODE_TYPE(child) == JSON_NODE_OBJECT) {
+					int c = collect(json_node_get_object(child), index);
+					if(c >= 0) definitions[index].children.push_back(c);
+				}
+				else if(JSON_NODE_TYPE(child) == JSON_NODE_VALUE && json_node_get_value_type(child) == G_TYPE_STRING) {
+					definitions[index].children.push_back(-1 - (int)references.size());
+					references.push_back(json_node_get_string(child));
+				}
+			}
+		}
+	}
+	return index;
+}
+
+
+//------------------------------------------------------------
+void Converter::addRecord(const char* name, JsonNode* node, const string& owner) {
+	ofxClutterSceneProperty property = ofxClutterScene::findProperty(name);
+	GValue value = { 0 };
+	if(!ofxClutterScene::readValue(node, property, &value)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterScene: skipping " + string(name) + " of " + owner + ", it isn't a plain value");
+		return;
+	}
+	
+	ofxClutterSceneRecord record;
+	memset(&record, 0, sizeof(record));
+	record.property = property;
+	record.name = intern(name);
+	switch(G_VALUE_TYPE(&value)) {
+		case G_TYPE_INT:
+			record.kind = RECORD_INT;
+			record.value.i = g_value_get_int(&value);
+			break;
+		case G_TYPE_FLOAT:
+			record.kind = RECORD_FLOAT;
+			record.value.f = g_value_get_float(&value);
+			break;
+		case G_TYPE_BOOLEAN:
+			record.kind = RECORD_BOOL;
+			record.value.i = g_value_get_boolean(&value);
+			break;
+		case G_TYPE_STRING:
+			record.kind = RECORD_STRING;
+			record.value.string = intern(g_value_get_string(&value));
+			break;
+		default: {
+			const ClutterColor* c = clutter_value_get_color(&value);
+			record.kind = RECORD_COLOR;
+			record.value.rgba = (c->red << 24) | (c->green << 16) | (c->blue << 8) | c->alpha;
+			break;
+		}
+	}
+	records.push_back(record);
+	g_value_unset(&value);
+}
+
+
+//------------------------------------------------------------
+// Parents before children, so the loader can build the tree in one pass
+void Converter::emit(int d, int parent) {
+	Definition& def = definitions[d];
+	int index = nodes.size();
+	
+	ofxClutterSceneNode node;
+	memset(&node, 0, sizeof(node));
+	node.type = ofxClutterScene::findType(def.type.c_str());
+	node.typeName = (node.type == OFX_CLUTTER_SCENE_OTHER) ? intern(def.type) : 0;
+	node.id = intern(def.id);
+	node.parent = parent;
+	node.firstRecord = records.size();
+	
+	string owner = def.id.empty() ? def.type : def.id;
+	GList* members = json_object_get_members(def.object);
+	for(int pass=0; pass<2; pass++) {
+		for(GList* m = members; m; m = m->next) {
+			const char* name = (const char*)m->data;
+			if(isStructural(name)) continue;
+			if(isContent(ofxClutterScene::findProperty(name)) != (pass == 0)) continue;
+			addRecord(name, json_object_get_member(def.object, name), owner);
+		}
+	}
+	g_list_free(members);
+	
+	node.numRecords = records.size() - node.firstRecord;
+	nodes.push_back(node);
+	
+	for(int i=0; i<def.children.size(); i++) {
+		if(def.children[i] >= 0) emit(def.children[i], index);
+	}
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterScene::convert(string jsonPath, string scenePath) {
+	jsonPath = ofToDataPath(jsonPath);
+	scenePath = ofToDataPath(scenePath);
+	
+	JsonParser* parser = json_parser_new();
+	GError* error = NULL;
+	if(!json_parser_load_from_file(parser, jsonPath.c_str(), &error)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't parse " + jsonPath);
+		fprintf(stderr, "%s\n", error->message);
+		g_error_free(error);
+		g_object_unref(parser);
+		return false;
+	}
+	
+	// A ClutterScript file is one object or an array of them
+	Converter converter;
+	converter.intern("");
+	vector<int> roots;
+	JsonNode* root = json_parser_get_root(parser);
+	if(JSON_NODE_TYPE(root) == JSON_NODE_OBJECT) {
+		roots.push_back(converter.collect(json_node_get_object(root), -1));
+	}
+	else if(JSON_NODE_TYPE(root) == JSON_NODE_ARRAY) {
+		JsonArray* array = json_node_get_array(root);
+		for(int i=0; i<json_array_get_length(array); i++) {
+			JsonNode* element = json_array_get_element(array, i);
+			if(JSON_NODE_TYPE(element) == JSON_NODE_OBJECT) {
+				roots.push_back(converter.collect(json_node_get_object(element), -1));
+			}
+		}
+	}
+	
+	// Children given by id are top-level objects; move them under their parent
+	vector<Definition>& defs = converter.definitions;
+	for(int d=0; d<defs.size(); d++) {
+		for(int i=0; i<defs[d].children.size(); i++) {
+			int c = defs[d].children[i];
+			if(c >= 0) continue;
+			const string& id = converter.references[-1 - c];
+			int found = -1;
+			for(int j=0; j<defs.size(); j++) {
+				if(defs[j].id == id) {
+					found = j;
+					break;
+				}
+			}
+			if(found < 0 || defs[found].parent != -1 || found == d) {
+				ofLog(OF_LOG_WARNING, "ofxClutterScene: child " + id + " of " + defs[d].id + " is missing or already has a parent");
+				continue;
+			}
+			defs[found].parent = d;
+			defs[d].children[i] = found;
+		}
+	}
+	for(int i=0; i<roots.size(); i++) {
+		if(roots[i] >= 0 && defs[roots[i]].parent == -1) converter.emit(roots[i], -1);
+	}
+	
+	// Id index, for lookups by binary search straight from the mapping
+	vector<pair<string, guint32> > ids;
+	for(int i=0; i<converter.nodes.size(); i++) {
+		const string& id = converter.strings[converter.nodes[i].id];
+		if(!id.empty()) ids.push_back(make_pair(id, (guint32)i));
+	}
+	sort(ids.begin(), ids.end());
+	for(int i=1; i<ids.size(); i++) {
+		if(ids[i].first == ids[i-1].first) {
+			ofLog(OF_LOG_WARNING, "ofxClutterScene: id " + ids[i].first + " is used more than once");
+		}
+	}
+	
+	vector<guint32> offsets;
+	string blob;
+	for(int i=0; i<converter.strings.size(); i++) {
+		offsets.push_back(blob.size());
+		blob.append(converter.strings[i].c_str(), converter.strings[i].size() + 1);
+	}
+	
+	ofxClutterSceneHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, sceneMagic, sizeof(sceneMagic));
+	header.numNodes = converter.nodes.size();
+	header.numRecords = converter.records.size();
+	header.numIds = ids.size();
+	header.numStrings = offsets.size();
+	header.stringBytes = blob.size();
+	
+	vector<guint32> idIndex;
+	for(int i=0; i<ids.size(); i++) idIndex.push_back(ids[i].second);
+	
+	g_object_unref(parser);
+	
+	// Write to a temporary name and rename, so a running app never maps half a file
+	string tmpPath = scenePath + ".tmp";
+	FILE* f = fopen(tmpPath.c_str(), "wb");
+	if(f == NULL) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't write " + scenePath);
+		return false;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+	if(header.numNodes) written = written && fwrite(&converter.nodes[0], sizeof(ofxClutterSceneNode), header.numNodes, f) == header.numNodes;
+	if(header.numRecords) written = written && fwrite(&converter.records[0], sizeof(ofxClutterSceneRecord), header.numRecords, f) == header.numRecords;
+	if(header.numIds) written = written && fwrite(&idIndex[0], sizeof(guint32), header.numIds, f) == header.numIds;
+	written = written && fwrite(&offsets[0], sizeof(guint32), header.numStrings, f) == header.numStrings;
+	written = written && fwrite(blob.data(), blob.size(), 1, f) == 1;
+	written = (fclose(f) == 0) && written;
+	if(!written || rename(tmpPath.c_str(), scenePath.c_str()) != 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't write " + scenePath);
+		unlink(tmpPath.c_str());
+		return false;
+	}
+	
+	ofLog(OF_LOG_NOTICE, "ofxClutterScene: converted " + jsonPath + ", " + ofToString((int)header.numNodes) + " actors, "
+		  + ofToString((int)header.numRecords) + " properties, " + ofToString((int)header.numStrings) + " strings");
+	return true;
+}
+
+
+//------------------------------------------------------------
+// Loading
+//------------------------------------------------------------
+bool ofxClutterScene::load(string scenePath) {
+	clear();
+	scenePath = ofToDataPath(scenePath);
+	GTimer* timer = g_timer_new();
+	
+	int fd = open(scenePath.c_str(), O_RDONLY);
+	if(fd < 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't open " + scenePath);
+		g_timer_destroy(timer);
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ofxClutterSceneHeader)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: " + scenePath + " isn't a scene file");
+		close(fd);
+		g_timer_destroy(timer);
+		return false;
+	}
+	mappedSize = st.st_size;
+	mapped = mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: couldn't map " + scenePath);
+		mapped = NULL;
+		g_timer_destroy(timer);
+		return false;
+	}
+	
+	// Check the sections fit before trusting any of them
+	header = (const ofxClutterSceneHeader*)mapped;
+	guint64 size = sizeof(ofxClutterSceneHeader)
+				+ (guint64)header->numNodes * sizeof(ofxClutterSceneNode)
+				+ (guint64)header->numRecords * sizeof(ofxClutterSceneRecord)
+				+ (guint64)header->numIds * sizeof(guint32)
+				+ (guint64)header->numStrings * sizeof(guint32)
+				+ header->stringBytes;
+	const char* p = (const char*)mapped + sizeof(ofxClutterSceneHeader);
+	nodes = (const ofxClutterSceneNode*)p;
+	p += header->numNodes * sizeof(ofxClutterSceneNode);
+	records = (const ofxClutterSceneRecord*)p;
+	p += header->numRecords * sizeof(ofxClutterSceneRecord);
+	idIndex = (const guint32*)p;
+	p += header->numIds * sizeof(guint32);
+	stringOffsets = (const guint32*)p;
+	p += header->numStrings * sizeof(guint32);
+	strings = p;
+	
+	if(memcmp(header->magic, sceneMagic, sizeof(sceneMagic)) != 0 || size > mappedSize
+	   || header->numStrings == 0 || header->stringBytes == 0 || strings[header->stringBytes - 1] != '\0') {
+		ofLog(OF_LOG_ERROR, "ofxClutterScene: " + scenePath + " is corrupt or from another version; convert it again");
+		clear();
+		g_timer_destroy(timer);
+		return false;
+	}
+	
+	numNodes = header->numNodes;
+	actors.assign(numNodes, (ClutterActor*)NULL);
+	wrappers.assign(numNodes, (ofxClutterActor*)NULL);
+	
+	for(int i=0; i<numNodes; i++) {
+		const ofxClutterSceneNode& node = nodes[i];
+		
+		// A child of an actor that failed is skipped with it
+		ClutterActor* parent = stage;
+		if(node.parent >= 0) {
+			if(node.parent >= i || actors[node.parent] == NULL) continue;
+			parent = actors[node.parent];
+		}
+		
+		ClutterActor* actor = createActor((ofxClutterSceneType)node.type, getString(node.typeName));
+		if(actor == NULL) continue;
+		g_object_ref_sink(actor);
+		actors[i] = actor;
+		
+		if(actor != stage) {
+			if(!CLUTTER_IS_CONTAINER(parent)) {
+				ofLog(OF_LOG_ERROR, "ofxClutterScene: " + string(getString(node.id)) + "'s parent can't have children");
+				g_object_unref(actor);
+				actors[i] = NULL;
+				continue;
+			}
+			clutter_container_add_actor(CLUTTER_CONTAINER(parent), actor);
+			clutter_actor_show(actor);
+		}
+		
+		guint32 end = MIN(node.firstRecord + node.numRecords, header->numRecords);
+		for(guint32 r = node.firstRecord; r < end; r++) {
+			const ofxClutterSceneRecord& record = records[r];
+			if(record.property >= OFX_CLUTTER_SCENE_NUM_PROPERTIES) continue;
+			
+			ClutterColor color;
+			GValue value = { 0 };
+			switch(record.kind) {
+				case RECORD_INT:
+					g_value_init(&value, G_TYPE_INT);
+					g_value_set_int(&value, record.value.i);
+					break;
+				case RECORD_FLOAT:
+					g_value_init(&value, G_TYPE_FLOAT);
+					g_value_set_float(&value, record.value.f);
+					break;
+				case RECORD_BOOL:
+					g_value_init(&value, G_TYPE_BOOLEAN);
+					g_value_set_boolean(&value, record.value.i);
+					break;
+				case RECORD_STRING:
+					g_value_init(&value, G_TYPE_STRING);
+					g_value_set_static_string(&value, getString(record.value.string));
+					break;
+				case RECORD_COLOR:
+					color.red = record.value.rgba >> 24;
+					color.green = record.value.rgba >> 16;
+					color.blue = record.value.rgba >> 8;
+					color.alpha = record.value.rgba;
+					g_value_init(&value, CLUTTER_TYPE_COLOR);
+					g_value_set_static_boxed(&value, &color);
+					break;
+				default:
+					continue;
+			}
+			setProperty(actor, (ofxClutterSceneProperty)record.property, getString(record.name), &value);
+			g_value_unset(&value);
+		}
+	}
+	
+	loadMillis = g_timer_elapsed(timer, NULL) * 1000;
+	g_timer_destroy(timer);
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterScene::clear() {
+	for(int i=0; i<actors.size(); i++) {
+		if(actors[i] == NULL) continue;
+		// Destroying a root takes its children with it
+		bool isRoot = nodes[i].parent < 0 || actors[nodes[i].parent] == stage;
+		if(actors[i] != stage && isRoot) clutter_actor_destroy(actors[i]);
+	}
+	for(int i=0; i<actors.size(); i++) {
+		if(actors[i]) g_object_unref(actors[i]);
+		delete wrappers[i];
+	}
+	actors.clear();
+	wrappers.clear();
+	numNodes = 0;
+	
+	if(mapped) munmap(mapped, mappedSize);
+	mapped = NULL;
+	mappedSize = 0;
+}
+
+
+//------------------------------------------------------------
+const char* ofxClutterScene::getString(guint32 index) {
+	if(index >= header->numStrings || stringOffsets[index] >= header->stringBytes) return "";
+	return strings + stringOffsets[index];
+}
+
+
+//------------------------------------------------------------
+int ofxClutterScene::findNode(const char* id) {
+	int lo = 0, hi = (int)header->numIds - 1;
+	while(lo <= hi) {
+		int mid = (lo + hi) / 2;
+		guint32 node = idIndex[mid];
+		if(node >= header->numNodes) return -1;
+		int c = strcmp(id, getString(nodes[node].id));
+		if(c == 0) return node;
+		if(c < 0) hi = mid - 1;
+		else lo = mid + 1;
+	}
+	return -1;
+}
+
+
+//------------------------------------------------------------
+ClutterActor* ofxClutterScene::get(string id) {
+	if(mapped == NULL) return NULL;
+	int i = findNode(id.c_str());
+	return (i < 0) ? NULL : actors[i];
+}
+
+
+//------------------------------------------------------------
+ofxClutterActor* ofxClutterScene::getActor(string id) {
+	if(mapped == NULL) return NULL;
+	int i = findNode(id.c_str());
+	if(i < 0 || actors[i] == NULL) return NULL;
+	if(wrappers[i] == NULL) {
+		wrappers[i] = new ofxClutterActor();
+		wrappers[i]->actor = actors[i];
+	}
+	return wrappers[i];
+}
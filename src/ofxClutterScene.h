@@ -0,0 +1,125 @@
+/*
+ *  ofxClutterScene.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include <json-glib/json-glib.h>
+
+struct ofxClutterSceneHeader;
+struct ofxClutterSceneNode;
+struct ofxClutterSceneRecord;
+
+// Actor types the loader creates directly; anything else is looked up by
+// GType name (the type must already be registered)
+enum ofxClutterSceneType {
+	OFX_CLUTTER_SCENE_OTHER,
+	OFX_CLUTTER_SCENE_STAGE,		// the existing stage; its children become root actors
+	OFX_CLUTTER_SCENE_GROUP,
+	OFX_CLUTTER_SCENE_RECTANGLE,
+	OFX_CLUTTER_SCENE_TEXT,
+	OFX_CLUTTER_SCENE_TEXTURE,
+	OFX_CLUTTER_SCENE_NUM_TYPES
+};
+
+// Properties set with their own setter instead of by name through GObject
+enum ofxClutterSceneProperty {
+	OFX_CLUTTER_SCENE_GENERIC,		// anything else, set with g_object_set_property
+	OFX_CLUTTER_SCENE_X,
+	OFX_CLUTTER_SCENE_Y,
+	OFX_CLUTTER_SCENE_WIDTH,
+	OFX_CLUTTER_SCENE_HEIGHT,
+	OFX_CLUTTER_SCENE_DEPTH,
+	OFX_CLUTTER_SCENE_OPACITY,
+	OFX_CLUTTER_SCENE_VISIBLE,
+	OFX_CLUTTER_SCENE_REACTIVE,
+	OFX_CLUTTER_SCENE_NAME,
+	OFX_CLUTTER_SCENE_SCALE_X,
+	OFX_CLUTTER_SCENE_SCALE_Y,
+	OFX_CLUTTER_SCENE_ROTATION_Z,
+	OFX_CLUTTER_SCENE_ANCHOR_X,
+	OFX_CLUTTER_SCENE_ANCHOR_Y,
+	OFX_CLUTTER_SCENE_COLOR,		// rectangle, text or stage
+	OFX_CLUTTER_SCENE_BORDER_COLOR,
+	OFX_CLUTTER_SCENE_BORDER_WIDTH,
+	OFX_CLUTTER_SCENE_TEXT_STRING,
+	OFX_CLUTTER_SCENE_FONT_NAME,
+	OFX_CLUTTER_SCENE_USE_MARKUP,
+	OFX_CLUTTER_SCENE_FILENAME,
+	OFX_CLUTTER_SCENE_NUM_PROPERTIES
+};
+
+
+// Loads actor trees from a compiled scene file, which convert() makes from
+// a ClutterScript JSON file.  The file is mmapped and read in one pass: a
+// flat table of nodes, parents before children, each pointing at a run of
+// property records.  Strings are interned in one table, and properties
+// ClutterScript would look up by name are stored as ofxClutterSceneProperty
+// and applied with their setters, so loading is mostly clutter_*_new and
+// clutter_actor_set_* calls.  The file uses the machine's byte order;
+// rebuild it from the JSON rather than shipping it between platforms.
+//
+// Only actors and their properties are converted.  Signals, behaviours
+// and non-actor objects are left out with a warning.
+class ofxClutterScene {
+public:
+	ofxClutterScene();
+	~ofxClutterScene();
+	
+	static bool convert(string jsonPath, string scenePath);
+	
+	// Root actors are added to the stage.  Loading again replaces the scene.
+	bool load(string scenePath);
+	void clear();		// destroys the loaded actors
+	
+	// Actors by their ClutterScript "id", NULL if there is none
+	ClutterActor* get(string id);
+	ofxClutterActor* getActor(string id);
+	
+	int getNumActors() { return numNodes; }
+	float getLoadMillis() { return loadMillis; }
+	
+	// Shared with the JSON hot-reloader
+	static ofxClutterSceneType findType(const char* name);
+	static ofxClutterSceneProperty findProperty(const char* name);
+	static ClutterActor* createActor(ofxClutterSceneType type, const char* typeName);
+	
+	// The GType for a type name, registering it first if need be the way
+	// ClutterScript does: through its <type>_get_type() function, e.g.
+	// clutter_behaviour_opacity_get_type for ClutterBehaviourOpacity.
+	// 0 if there is no such type.
+	static GType resolveType(const char* name);
+	
+	// Sets one property; value may hold any type that converts to the
+	// property's.  Strings convert to colors and enums too.
+	static bool setProperty(ClutterActor* actor, ofxClutterSceneProperty property, const char* name, const GValue* value);
+	
+	// Puts a property back to what it is on a fresh actor; width and
+	// height go back to the preferred size
+	static void resetProperty(ClutterActor* actor, ofxClutterSceneProperty property, const char* name);
+	static const char* getPropertyName(ofxClutterSceneProperty property);
+	
+	// A JSON scalar, or a color array/string for color properties, as a
+	// GValue.  Returns false, leaving value unset, for anything else.
+	static bool readValue(JsonNode* node, ofxClutterSceneProperty property, GValue* value);
+	
+protected:
+	int findNode(const char* id);
+	const char* getString(guint32 index);
+	
+	void* mapped;
+	size_t mappedSize;
+	const ofxClutterSceneHeader* header;
+	const ofxClutterSceneNode* nodes;
+	const ofxClutterSceneRecord* records;
+	const guint32* idIndex;			// node indices, sorted by id
+	const guint32* stringOffsets;
+	const char* strings;
+	
+	int numNodes;
+	vector<ClutterActor*> actors;	// one per node, referenced, NULL if it failed
+	vector<ofxClutterActor*> wrappers;
+	float loadMillis;
+};
@@ -0,0 +1,166 @@
+/*
+ *  ofxClutterShaderEffect.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterShaderEffect.h"
+
+map<string, ofxClutterShaderEffect::Program> ofxClutterShaderEffect::programs;
+int ofxClutterShaderEffect::numUniformsSent = 0;
+int ofxClutterShaderEffect::numUniformsSkipped = 0;
+
+
+//------------------------------------------------------------
+ofxClutterShaderEffect::ofxClutterShaderEffect(string fragmentSource) {
+	this->fragmentSource = fragmentSource;
+	program = getProgram(fragmentSource);
+	passMaterial = cogl_material_new();
+	if(program) cogl_material_set_user_program(passMaterial, program->handle);
+	
+	// The actor's image is always on the first layer
+	setUniform("tex", 0);
+}
+
+
+//------------------------------------------------------------
+ofxClutterShaderEffect::~ofxClutterShaderEffect() {
+	remove();
+	cogl_handle_unref(passMaterial);
+	
+	if(program && --program->refs == 0) {
+		cogl_handle_unref(program->handle);
+		programs.erase(fragmentSource);
+	}
+}
+
+
+//------------------------------------------------------------
+// Compiles each distinct source once
+ofxClutterShaderEffect::Program* ofxClutterShaderEffect::getProgram(const string& source) {
+	map<string, Program>::iterator it = programs.find(source);
+	if(it != programs.end()) {
+		it->second.refs++;
+		return &it->second;
+	}
+	
+	CoglHandle shader = cogl_create_shader(COGL_SHADER_TYPE_FRAGMENT);
+	cogl_shader_source(shader, source.c_str());
+	cogl_shader_compile(shader);
+	if(!cogl_shader_is_compiled(shader)) {
+		char* log = cogl_shader_get_info_log(shader);
+		ofLog(OF_LOG_ERROR, "ofxClutterShaderEffect: shader didn't compile.");
+		fprintf (stderr, "%s\n", log);
+		g_free(log);
+		cogl_handle_unref(shader);
+		return NULL;
+	}
+	
+	Program& program = programs[source];
+	program.handle = cogl_create_program();
+	program.refs = 1;
+	cogl_program_attach_shader(program.handle, shader);
+	cogl_program_link(program.handle);
+	cogl_handle_unref(shader);
+	return &program;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::setUniform(string name, int value) {
+	float v = value;
+	setUniform(name, &v, 1, true);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::setUniform(string name, float value) {
+	setUniform(name, &value, 1, false);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::setUniform(string name, float x, float y) {
+	float v[2] = {x, y};
+	setUniform(name, v, 2, false);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::setUniform(string name, float x, float y, float z) {
+	float v[3] = {x, y, z};
+	setUniform(name, v, 3, false);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::setUniform(string name, float x, float y, float z, float w) {
+	float v[4] = {x, y, z, w};
+	setUniform(name, v, 4, false);
+}
+
+
+//------------------------------------------------------------
+// Only stores the value; it goes to the program when the actor paints
+void ofxClutterShaderEffect::setUniform(string name, const float* values, int count, bool isInt) {
+	if(program == NULL) return;
+	
+	int i = find(uniformNames.begin(), uniformNames.end(), name) - uniformNames.begin();
+	if(i == uniformNames.size()) {
+		int location = cogl_program_get_uniform_location(program->handle, name.c_str());
+		if(location < 0) return;
+		Uniform u;
+		u.location = location;
+		uniforms.push_back(u);
+		uniformNames.push_back(name);
+	}
+	
+	else if(uniforms[i].count == count && uniforms[i].isInt == isInt
+			&& memcmp(uniforms[i].values, values, count * sizeof(float)) == 0) {
+		return;
+	}
+	
+	Uniform& u = uniforms[i];
+	u.count = count;
+	u.isInt = isInt;
+	for(int j=0; j<count; j++) u.values[j] = values[j];
+	invalidate();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShaderEffect::sendUniforms() {
+	for(int i=0; i<uniforms.size(); i++) {
+		Uniform& u = uniforms[i];
+		map<int, Uniform>::iterator it = program->sent.find(u.location);
+		if(it != program->sent.end() && it->second.count == u.count && it->second.isInt == u.isInt
+		   && memcmp(it->second.values, u.values, u.count * sizeof(float)) == 0) {
+			numUniformsSkipped++;
+			continue;
+		}
+		
+		if(u.isInt) {
+			int v[4];
+			for(int j=0; j<u.count; j++) v[j] = u.values[j];
+			cogl_program_set_uniform_int(program->handle, u.location, u.count, 1, v);
+		}
+		else {
+			cogl_program_set_uniform_float(program->handle, u.location, u.count, 1, u.values);
+		}
+		program->sent[u.location] = u;
+		numUniformsSent++;
+	}
+}
+
+
+//------------------------------------------------------------
+CoglHandle ofxClutterShaderEffect::process(CoglHandle source, int w, int h) {
+	if(program == NULL) return source;
+	CoglHandle dest = ofxClutterOffscreenPool::acquire(w, h);
+	if(dest == COGL_INVALID_HANDLE) return source;
+	
+	sendUniforms();
+	cogl_material_set_layer(passMaterial, 0, source);
+	drawInto(dest, passMaterial);
+	return dest;
+}
@@ -0,0 +1,65 @@
+/*
+ *  ofxClutterShaderEffect.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterCachedEffect.h"
+
+
+// Runs a GLSL fragment shader over an actor, like ClutterShaderEffect, but
+// every effect with the same source shares one compiled program.  Sampler
+// "tex" is the actor's offscreen image.
+//
+// Uniforms belong to the shared program, so each effect keeps its own
+// values and sends only the ones that differ from what the program last
+// saw.  A hundred actors with the same color grade send them once a frame.
+// The shaded image is cached until the actor or a uniform changes.
+class ofxClutterShaderEffect : public ofxClutterCachedEffect {
+public:
+	ofxClutterShaderEffect(string fragmentSource);
+	~ofxClutterShaderEffect();
+	
+	// False if the shader didn't compile
+	bool isLoaded() { return program != NULL; }
+	
+	void setUniform(string name, int value);
+	void setUniform(string name, float value);
+	void setUniform(string name, float x, float y);
+	void setUniform(string name, float x, float y, float z);
+	void setUniform(string name, float x, float y, float z, float w);
+	
+	static int getNumPrograms() { return programs.size(); }
+	static int getNumUniformsSent() { return numUniformsSent; }
+	static int getNumUniformsSkipped() { return numUniformsSkipped; }
+	
+protected:
+	struct Uniform {
+		int location;
+		int count;
+		bool isInt;
+		float values[4];
+	};
+	
+	struct Program {
+		CoglHandle handle;
+		int refs;
+		map<int, Uniform> sent;
+	};
+	
+	CoglHandle process(CoglHandle source, int w, int h);
+	void setUniform(string name, const float* values, int count, bool isInt);
+	void sendUniforms();
+	static Program* getProgram(const string& source);
+	
+	string fragmentSource;
+	Program* program;
+	CoglMaterial* passMaterial;
+	vector<Uniform> uniforms;
+	vector<string> uniformNames;
+	
+	static map<string, Program> programs;
+	static int numUniformsSent;
+	static int numUniformsSkipped;
+};
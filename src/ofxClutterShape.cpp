@@ -0,0 +1,240 @@
+/*
+ *  ofxClutterShape.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterShape.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+// Degrees per segment for rounded corners
+static const int arcStep = 10;
+
+map<string, ofxClutterShape::SharedPath> ofxClutterShape::paths;
+int ofxClutterShape::rebuildsThisFrame = 0;
+int ofxClutterShape::rebuildsLastFrame = 0;
+int ofxClutterShape::totalRebuilds = 0;
+
+
+//------------------------------------------------------------
+ofxClutterShape::ofxClutterShape() {
+	actor = clutter_group_new();
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	g_signal_connect_after(actor, "paint", G_CALLBACK(onPaint), this);
+	
+	static bool stageConnected = false;
+	if(!stageConnected) {
+		g_signal_connect_after(stage, "paint", G_CALLBACK(onStagePainted), NULL);
+		stageConnected = true;
+	}
+	
+	kind = NONE;
+	path = NULL;
+	ClutterColor white = { 255, 255, 255, 255 };
+	color = white;
+}
+
+
+//------------------------------------------------------------
+ofxClutterShape::~ofxClutterShape() {
+	clutter_actor_destroy(actor);
+	releasePath();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::setRoundedRect(float w, float h, float radius) {
+	vector<float> p(3);
+	p[0] = w;
+	p[1] = h;
+	p[2] = radius;
+	setGeometry(ROUNDED_RECT, p, w, h);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::setEllipse(float w, float h) {
+	vector<float> p(2);
+	p[0] = w;
+	p[1] = h;
+	setGeometry(ELLIPSE, p, w, h);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::setPolygon(const vector<ofPoint>& points) {
+	vector<float> p;
+	p.reserve(points.size() * 2);
+	float w = 0, h = 0;
+	for(int i=0; i<points.size(); i++) {
+		p.push_back(points[i].x);
+		p.push_back(points[i].y);
+		w = MAX(w, points[i].x);
+		h = MAX(h, points[i].y);
+	}
+	setGeometry(POLYGON, p, w, h);
+}
+
+
+//------------------------------------------------------------
+// Cogl only strokes hairlines, so wide lines are filled as one quad per
+// segment.  params holds the width and closed flag, then the points.
+void ofxClutterShape::setStroke(const vector<ofPoint>& points, float lineWidth, bool closed) {
+	vector<float> p;
+	p.reserve(2 + points.size() * 2);
+	p.push_back(lineWidth);
+	p.push_back(closed ? 1 : 0);
+	float w = 0, h = 0;
+	for(int i=0; i<points.size(); i++) {
+		p.push_back(points[i].x);
+		p.push_back(points[i].y);
+		w = MAX(w, points[i].x + lineWidth / 2);
+		h = MAX(h, points[i].y + lineWidth / 2);
+	}
+	setGeometry(STROKE, p, w, h);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::setColor(int r, int g, int b, int a) {
+	if(color.red == r && color.green == g && color.blue == b && color.alpha == a) return;
+	color.red = r;
+	color.green = g;
+	color.blue = b;
+	color.alpha = a;
+	clutter_actor_queue_redraw(actor);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::setColor(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterShape: unknown color " + color);
+		return;
+	}
+	setColor(col.red, col.green, col.blue, col.alpha);
+}
+
+
+//------------------------------------------------------------
+// The key is the kind followed by the raw parameter bytes, so setting the
+// same geometry again is a no-op and equal shapes land on the same path.
+void ofxClutterShape::setGeometry(Kind kind, const vector<float>& params, float w, float h) {
+	string newKey(1, (char)kind);
+	if(params.size()) newKey.append((const char*)&params[0], params.size() * sizeof(float));
+	if(newKey == key) return;
+	
+	releasePath();
+	this->kind = kind;
+	this->params = params;
+	key = newKey;
+	clutter_actor_set_size(actor, w, h);
+	clutter_actor_queue_redraw(actor);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::releasePath() {
+	if(path == NULL) return;
+	map<string, SharedPath>::iterator it = paths.find(key);
+	if(it != paths.end() && --it->second.refs == 0) {
+		cogl_handle_unref(it->second.path);
+		paths.erase(it);
+	}
+	path = NULL;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::buildPath() {
+	map<string, SharedPath>::iterator it = paths.find(key);
+	if(it != paths.end()) {
+		it->second.refs++;
+		path = it->second.path;
+		return;
+	}
+	
+	cogl_path_new();
+	switch(kind) {
+		case ROUNDED_RECT:
+			cogl_path_round_rectangle(0, 0, params[0], params[1], params[2], arcStep);
+			break;
+		case ELLIPSE:
+			cogl_path_ellipse(params[0] / 2, params[1] / 2, params[0] / 2, params[1] / 2);
+			break;
+		case POLYGON:
+			if(params.size() >= 6) cogl_path_polygon(&params[0], params.size() / 2);
+			break;
+		case STROKE: {
+			// Every segment quad winds the same way, so with the non-zero
+			// rule the overlaps at the joints don't cancel out.
+			cogl_path_set_fill_rule(COGL_PATH_FILL_RULE_NON_ZERO);
+			float halfWidth = params[0] / 2;
+			bool closed = params[1] != 0;
+			int numPoints = (params.size() - 2) / 2;
+			const float* pts = &params[2];
+			int numSegments = closed ? numPoints : numPoints - 1;
+			for(int i=0; i<numSegments; i++) {
+				int j = (i + 1) % numPoints;
+				float dx = pts[j*2] - pts[i*2];
+				float dy = pts[j*2+1] - pts[i*2+1];
+				float len = sqrtf(dx*dx + dy*dy);
+				if(len == 0) continue;
+				float nx = -dy / len * halfWidth;
+				float ny = dx / len * halfWidth;
+				cogl_path_move_to(pts[i*2] + nx, pts[i*2+1] + ny);
+				cogl_path_line_to(pts[j*2] + nx, pts[j*2+1] + ny);
+				cogl_path_line_to(pts[j*2] - nx, pts[j*2+1] - ny);
+				cogl_path_line_to(pts[i*2] - nx, pts[i*2+1] - ny);
+				cogl_path_close();
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	
+	SharedPath shared;
+	shared.path = cogl_path_copy(cogl_get_path());
+	shared.refs = 1;
+	paths[key] = shared;
+	path = shared.path;
+	cogl_path_new();
+	
+	rebuildsThisFrame++;
+	totalRebuilds++;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::paint() {
+	if(kind == NONE) return;
+	if(path == NULL) buildPath();
+	
+	guint8 opacity = clutter_actor_get_paint_opacity(actor);
+	CoglColor col;
+	cogl_color_set_from_4ub(&col, color.red, color.green, color.blue, color.alpha * opacity / 255);
+	cogl_color_premultiply(&col);
+	cogl_set_source_color(&col);
+	cogl_set_path(path);
+	cogl_path_fill();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::onPaint(ClutterActor* actor, gpointer data) {
+	((ofxClutterShape*)data)->paint();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterShape::onStagePainted(ClutterActor* actor, gpointer data) {
+	rebuildsLastFrame = rebuildsThisFrame;
+	rebuildsThisFrame = 0;
+}
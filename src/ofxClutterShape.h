@@ -0,0 +1,60 @@
+/*
+ *  ofxClutterShape.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterColor.h"
+
+
+// A filled vector shape drawn with cogl_path: rounded rect, ellipse,
+// polygon or a stroked polyline.  The path is built once per geometry and
+// kept until the geometry changes; shapes with identical geometry share a
+// single path object, so a thousand identical buttons build one path.
+class ofxClutterShape : public ofxClutterActor {
+public:
+	ofxClutterShape();
+	~ofxClutterShape();
+	
+	void setRoundedRect(float w, float h, float radius);
+	void setEllipse(float w, float h);
+	void setPolygon(const vector<ofPoint>& points);
+	void setStroke(const vector<ofPoint>& points, float lineWidth, bool closed=false);
+	
+	void setColor(int r, int g, int b, int a=255);
+	void setColor(const string& color);		// CSS/X11 name or #rrggbb[aa]
+	
+	// Paths built during the last stage paint.  Anything above zero on a
+	// static scene means some geometry is being set every frame.
+	static int getNumPathRebuilds() { return rebuildsLastFrame; }
+	static int getTotalPathRebuilds() { return totalRebuilds; }
+	static int getNumSharedPaths() { return paths.size(); }
+	
+protected:
+	enum Kind { NONE, ROUNDED_RECT, ELLIPSE, POLYGON, STROKE };
+	
+	struct SharedPath {
+		CoglPath* path;
+		int refs;
+	};
+	
+	void setGeometry(Kind kind, const vector<float>& params, float w, float h);
+	void releasePath();
+	void buildPath();
+	void paint();
+	static void onPaint(ClutterActor* actor, gpointer data);
+	static void onStagePainted(ClutterActor* actor, gpointer data);
+	
+	Kind kind;
+	vector<float> params;
+	string key;
+	CoglPath* path;
+	ClutterColor color;
+	
+	static map<string, SharedPath> paths;
+	static int rebuildsThisFrame;
+	static int rebuildsLastFrame;
+	static int totalRebuilds;
+};
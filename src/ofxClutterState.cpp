@@ -0,0 +1,103 @@
+/*
+ *  ofxClutterState.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterState.h"
+
+
+//------------------------------------------------------------
+ofxClutterState::ofxClutterState() {
+	duration = 1000;
+}
+
+
+//------------------------------------------------------------
+// Setting the same actor and property again replaces the key
+void ofxClutterState::set(string state, ofxClutterActor* actor, ofxClutterTweenProperty property, float value,
+						  int mode, float delayMillis) {
+	vector<Key>& keys = states[state];
+	Key key;
+	key.actor = actor;
+	key.property = property;
+	key.value = value;
+	key.mode = mode;
+	key.delay = delayMillis;
+	
+	for(int i=0; i<keys.size(); i++) {
+		if(keys[i].actor == actor && keys[i].property == property) {
+			keys[i] = key;
+			return;
+		}
+	}
+	keys.push_back(key);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterState::setDuration(string source, string target, float millis) {
+	durations[make_pair(source, target)] = millis;
+}
+
+
+//------------------------------------------------------------
+float ofxClutterState::getDuration(string source, string target) {
+	map<pair<string, string>, float>::iterator it = durations.find(make_pair(source, target));
+	return (it == durations.end()) ? duration : it->second;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterState::setState(string state) {
+	map<string, vector<Key> >::iterator it = states.find(state);
+	if(it == states.end()) {
+		ofLog(OF_LOG_WARNING, "ofxClutterState: no state named " + state);
+		return;
+	}
+	
+	float millis = getDuration(current, state);
+	vector<Key>& keys = it->second;
+	for(int i=0; i<keys.size(); i++) {
+		ofxClutterTween::add(keys[i].actor, keys[i].property, keys[i].value, millis, keys[i].mode, keys[i].delay);
+	}
+	current = state;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterState::warpToState(string state) {
+	map<string, vector<Key> >::iterator it = states.find(state);
+	if(it == states.end()) {
+		ofLog(OF_LOG_WARNING, "ofxClutterState: no state named " + state);
+		return;
+	}
+	
+	vector<Key>& keys = it->second;
+	for(int i=0; i<keys.size(); i++) {
+		ofxClutterTween::set(keys[i].actor, keys[i].property, keys[i].value);
+	}
+	current = state;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterState::getNumKeys(string state) {
+	map<string, vector<Key> >::iterator it = states.find(state);
+	return (it == states.end()) ? 0 : it->second.size();
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterState::findProperty(string name, ofxClutterTweenProperty& property) {
+	static const char* names[OFX_CLUTTER_TWEEN_NUM_PROPERTIES] = {
+		"x", "y", "width", "height", "depth", "scale-x", "scale-y", "rotation-angle-z", "opacity"
+	};
+	for(int i=0; i<OFX_CLUTTER_TWEEN_NUM_PROPERTIES; i++) {
+		if(name == names[i]) {
+			property = (ofxClutterTweenProperty)i;
+			return true;
+		}
+	}
+	return false;
+}
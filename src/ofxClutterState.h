@@ -0,0 +1,52 @@
+/*
+ *  ofxClutterState.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterTween.h"
+
+
+// Named states for groups of actors, like ClutterState, but keyed by typed
+// property handles instead of property-name strings, and animated by
+// ofxClutterTween, so a transition is a handful of array writes per key
+// and no GParamSpec lookups or GValues per frame.  A state can hold keys
+// for hundreds of actors; give keys a delay to stagger them.
+class ofxClutterState {
+public:
+	ofxClutterState();
+	
+	// The easing mode of the state being entered is used, as in ClutterState
+	void set(string state, ofxClutterActor* actor, ofxClutterTweenProperty property, float value,
+			 int mode=CLUTTER_LINEAR, float delayMillis=0);
+	
+	// Default duration of every transition, and of one pair of states
+	void setDuration(float millis) { duration = millis; }
+	void setDuration(string source, string target, float millis);
+	float getDuration(string source, string target);
+	
+	void setState(string state);
+	void warpToState(string state);		// no animation
+	string getState() { return current; }
+	
+	int getNumKeys(string state);
+	
+	// Maps a ClutterActor property name ("x", "opacity", "scale-x",
+	// "rotation-angle-z", ...) to its handle, for porting clutter_state_set calls
+	static bool findProperty(string name, ofxClutterTweenProperty& property);
+	
+protected:
+	struct Key {
+		ofxClutterActor* actor;
+		ofxClutterTweenProperty property;
+		float value;
+		int mode;
+		float delay;
+	};
+	
+	map<string, vector<Key> > states;
+	map<pair<string, string>, float> durations;
+	float duration;
+	string current;
+};
@@ -8,16 +8,225 @@
  */
 
 #include "ofxClutterText.h"
+#include "ofxClutterTextMetrics.h"
+#include <cogl/cogl-pango.h>
 
 // We need access to the stage
 extern "C" {
 #include "ofxAppClutterWindow.h"
 };
 
+int ofxClutterText::numPreloadedGlyphs = 0;
+int ofxClutterText::preloadedGlyphBytes = 0;
+float ofxClutterText::preloadMillis = 0;
+
 
 //------------------------------------------------------------
 ofxClutterText::ofxClutterText() {
 	 actor = clutter_text_new();
-	 clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
-	 clutter_actor_show(actor);
-}
\ No newline at end of file
+	 init();
+}
+
+
+//------------------------------------------------------------
+ofxClutterText::ofxClutterText(string text, string font) {
+	actor = clutter_text_new_full(font.c_str(), text.c_str(), NULL);
+	init();
+	this->text = text;
+	this->font = font;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::init() {
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	
+	const gchar* defaultFont = clutter_text_get_font_name(CLUTTER_TEXT(actor));
+	font = defaultFont ? defaultFont : "";
+	useMarkup = false;
+	wrapWidth = -1;
+	numRelayouts = 0;
+	g_signal_connect(actor, "queue-relayout", G_CALLBACK(onQueueRelayout), this);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::onQueueRelayout(ClutterActor* actor, gpointer data) {
+	((ofxClutterText*)data)->numRelayouts++;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setText(string text) {
+	if(text == this->text && !useMarkup) return;
+	this->text = text;
+	useMarkup = false;
+	clutter_text_set_text(CLUTTER_TEXT(actor), text.c_str());
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setMarkup(string markup) {
+	if(markup == text && useMarkup) return;
+	text = markup;
+	useMarkup = true;
+	clutter_text_set_markup(CLUTTER_TEXT(actor), markup.c_str());
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setFont(string font) {
+	if(font == this->font) return;
+	this->font = font;
+	clutter_text_set_font_name(CLUTTER_TEXT(actor), font.c_str());
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setColor(int r, int g, int b, int a) {
+	ClutterColor col = {r, g, b, a};
+	ClutterColor current;
+	clutter_text_get_color(CLUTTER_TEXT(actor), &current);
+	if(clutter_color_equal(&col, &current)) return;
+	clutter_text_set_color(CLUTTER_TEXT(actor), &col);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setColor(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterText: unknown color " + color);
+		return;
+	}
+	setColor(col.red, col.green, col.blue, col.alpha);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setWrapWidth(int width) {
+	if(width == wrapWidth) return;
+	wrapWidth = width;
+	clutter_actor_set_width(actor, width);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setLineWrap(bool wrap, PangoWrapMode mode) {
+	ClutterText* t = CLUTTER_TEXT(actor);
+	if(clutter_text_get_line_wrap(t) != wrap) clutter_text_set_line_wrap(t, wrap);
+	if(clutter_text_get_line_wrap_mode(t) != mode) clutter_text_set_line_wrap_mode(t, mode);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setEllipsize(PangoEllipsizeMode mode) {
+	if(clutter_text_get_ellipsize(CLUTTER_TEXT(actor)) == mode) return;
+	clutter_text_set_ellipsize(CLUTTER_TEXT(actor), mode);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterText::setAlignment(PangoAlignment alignment) {
+	if(clutter_text_get_line_alignment(CLUTTER_TEXT(actor)) == alignment) return;
+	clutter_text_set_line_alignment(CLUTTER_TEXT(actor), alignment);
+}
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterText::measure(string text, string font, int wrapWidth) {
+	return ofxClutterTextMetrics::measure(text, font, wrapWidth);
+}
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterText::getTextSize() {
+	ClutterText* t = CLUTTER_TEXT(actor);
+	if(useMarkup || clutter_text_get_ellipsize(t) != PANGO_ELLIPSIZE_NONE) {
+		// Markup changes the metrics and ellipsizing depends on the
+		// allocation, so ask the actor
+		gfloat w, h;
+		clutter_actor_get_preferred_size(actor, NULL, NULL, &w, &h);
+		return ofPoint(w, h);
+	}
+	// ClutterText only wraps with line wrap on, however wide the actor is
+	int width = clutter_text_get_line_wrap(t) ? wrapWidth : -1;
+	return ofxClutterTextMetrics::measure(text, font, width, clutter_text_get_line_wrap_mode(t),
+										  clutter_text_get_line_alignment(t), clutter_text_get_single_line_mode(t));
+}
+
+
+//------------------------------------------------------------
+int ofxClutterText::preloadFont(string font, string characters) {
+	GTimer* timer = g_timer_new();
+	
+	// Same Pango context as every ClutterText, so the same glyph cache
+	PangoLayout* layout = pango_layout_new(clutter_actor_get_pango_context(stage));
+	PangoFontDescription* desc = pango_font_description_from_string(font.c_str());
+	pango_layout_set_font_description(layout, desc);
+	pango_font_description_free(desc);
+	pango_layout_set_text(layout, characters.c_str(), characters.size());
+	
+	cogl_pango_ensure_glyph_cache_for_layout(layout);
+	
+	// Count what went in
+	int glyphs = 0;
+	int bytes = 0;
+	PangoLayoutIter* iter = pango_layout_get_iter(layout);
+	do {
+		PangoLayoutRun* run = pango_layout_iter_get_run_readonly(iter);
+		if(!run) continue;
+		for(int i=0; i<run->glyphs->num_glyphs; i++) {
+			PangoRectangle ink;
+			pango_font_get_glyph_extents(run->item->analysis.font, run->glyphs->glyphs[i].glyph, &ink, NULL);
+			bytes += PANGO_PIXELS_CEIL(ink.width) * PANGO_PIXELS_CEIL(ink.height) * 4;
+			glyphs++;
+		}
+	} while(pango_layout_iter_next_run(iter));
+	pango_layout_iter_free(iter);
+	g_object_unref(layout);
+	
+	float millis = g_timer_elapsed(timer, NULL) * 1000;
+	g_timer_destroy(timer);
+	
+	numPreloadedGlyphs += glyphs;
+	preloadedGlyphBytes += bytes;
+	preloadMillis += millis;
+	ofLog(OF_LOG_NOTICE, "ofxClutterText: preloaded " + ofToString(glyphs) + " glyphs of \"" + font + "\" ("
+		  + ofToString(bytes / 1024) + " KB) in " + ofToString(millis, 1) + " ms");
+	return glyphs;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterText::preloadFonts(vector<string> fonts, string characters) {
+	int glyphs = 0;
+	for(int i=0; i<fonts.size(); i++) {
+		glyphs += preloadFont(fonts[i], characters);
+	}
+	return glyphs;
+}
+
+
+//------------------------------------------------------------
+string ofxClutterText::getCharacterRange(gunichar first, gunichar last) {
+	string chars;
+	for(gunichar c=first; c<=last; c++) {
+		gchar utf8[6];
+		chars.append(utf8, g_unichar_to_utf8(c, utf8));
+	}
+	return chars;
+}
+
+
+//------------------------------------------------------------
+string ofxClutterText::getDigitCharacters() {
+	return "0123456789.,:;-+%$()/ ";
+}
+
+
+//------------------------------------------------------------
+string ofxClutterText::getLatin1Characters() {
+	return getCharacterRange(0x20, 0x7E) + getCharacterRange(0xA0, 0xFF);
+}
@@ -9,10 +9,73 @@
 
 #pragma once
 #include "ofxClutterActor.h"
-
-
+#include "ofxClutterColor.h"
 
 class ofxClutterText : public ofxClutterActor {
 public:
 	ofxClutterText();
-};
\ No newline at end of file
+	ofxClutterText(string text, string font="Sans 12");
+	
+	// Setting the same value again is free; the wrapper only passes real
+	// changes on.  Every real change still makes ClutterText throw away its
+	// cached layouts and queue a relayout, whatever the width and font, so
+	// text that changes every frame costs a layout and a relayout every
+	// frame.  For many such labels, draw them with ofxClutterLabelBatch.
+	void setText(string text);
+	void setMarkup(string markup);
+	string getText() { return text; }
+	
+	void setFont(string font);		// Pango font description, e.g. "Helvetica Bold 24"
+	string getFont() { return font; }
+	
+	void setColor(int r, int g, int b, int a=255);
+	void setColor(const string& color);		// CSS/X11 name or #rrggbb[aa]
+	
+	// Wrap at the given width in pixels, or -1 to size to the text
+	void setWrapWidth(int width);
+	void setLineWrap(bool wrap, PangoWrapMode mode=PANGO_WRAP_WORD);
+	void setEllipsize(PangoEllipsizeMode mode);
+	void setAlignment(PangoAlignment alignment);
+	
+	// How many times this actor has asked the stage for a relayout
+	int getNumRelayouts() { return numRelayouts; }
+	void resetNumRelayouts() { numRelayouts = 0; }
+	
+	// Size of the current text with the actor's wrap, alignment and single
+	// line settings, through the shared ofxClutterTextMetrics cache.  Markup
+	// and ellipsized text are measured by the actor instead.
+	ofPoint getTextSize();
+	
+	// Size of a string without creating an actor; see ofxClutterTextMetrics
+	static ofPoint measure(string text, string font, int wrapWidth=-1);
+	
+	// Rasterizes the glyphs for the given characters into Cogl's glyph cache
+	// ahead of time, so the first frame that shows them doesn't hitch.  Call
+	// during a loading phase, after the window is set up, once per font
+	// description (size and weight are part of the cache key).  Returns the
+	// number of glyphs; totals are kept for all calls.
+	static int preloadFont(string font, string characters);
+	static int preloadFonts(vector<string> fonts, string characters);
+	static int getNumPreloadedGlyphs() { return numPreloadedGlyphs; }
+	static int getPreloadedGlyphBytes() { return preloadedGlyphBytes; }	// estimate, from ink extents
+	static float getPreloadMillis() { return preloadMillis; }
+	
+	// Character sets for preloading, as UTF-8
+	static string getCharacterRange(gunichar first, gunichar last);
+	static string getDigitCharacters();		// 0-9 and number punctuation
+	static string getLatin1Characters();	// printable ISO 8859-1
+	
+protected:
+	void init();
+	static void onQueueRelayout(ClutterActor* actor, gpointer data);
+	
+	string text;
+	bool useMarkup;
+	string font;
+	int wrapWidth;
+	int numRelayouts;
+	
+	static int numPreloadedGlyphs;
+	static int preloadedGlyphBytes;
+	static float preloadMillis;
+};
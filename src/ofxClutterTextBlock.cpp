@@ -0,0 +1,84 @@
+/*
+ *  ofxClutterTextBlock.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterTextBlock.h"
+#include "ofxClutterTextShaper.h"
+#include <cogl/cogl-pango.h>
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+//------------------------------------------------------------
+ofxClutterTextBlock::ofxClutterTextBlock() {
+	actor = clutter_group_new();
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	g_signal_connect_after(actor, "paint", G_CALLBACK(onPaint), this);
+	
+	layout = NULL;
+	ClutterColor black = { 0, 0, 0, 255 };
+	color = black;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTextBlock::~ofxClutterTextBlock() {
+	clutter_actor_destroy(actor);
+	if(layout) g_object_unref(layout);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextBlock::setLayout(const ofxClutterTextLayout& layout) {
+	if(layout.pango == this->layout) return;
+	if(layout.pango) g_object_ref(layout.pango);
+	if(this->layout) g_object_unref(this->layout);
+	this->layout = layout.pango;
+	
+	clutter_actor_set_size(actor, layout.width, layout.height);
+	clutter_actor_queue_redraw(actor);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextBlock::setColor(int r, int g, int b, int a) {
+	ClutterColor col = { r, g, b, a };
+	if(clutter_color_equal(&col, &color)) return;
+	color = col;
+	clutter_actor_queue_redraw(actor);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextBlock::setColor(const string& color) {
+	ClutterColor col;
+	if(!ofxClutterColor::parse(color, col)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTextBlock: unknown color " + color);
+		return;
+	}
+	setColor(col.red, col.green, col.blue, col.alpha);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextBlock::paint() {
+	if(layout == NULL) return;
+	
+	guint8 opacity = clutter_actor_get_paint_opacity(actor);
+	CoglColor col;
+	// Unpremultiplied, as ClutterText passes it; the renderer premultiplies
+	cogl_color_set_from_4ub(&col, color.red, color.green, color.blue, color.alpha * opacity / 255);
+	cogl_pango_render_layout(layout, 0, 0, &col, 0);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextBlock::onPaint(ClutterActor* actor, gpointer data) {
+	((ofxClutterTextBlock*)data)->paint();
+}
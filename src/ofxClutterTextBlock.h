@@ -0,0 +1,39 @@
+/*
+ *  ofxClutterTextBlock.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterColor.h"
+
+class ofxClutterTextLayout;
+
+
+// Shows a paragraph shaped by ofxClutterTextShaper.  It keeps the worker's
+// PangoLayout and paints it with cogl_pango_render_layout, sized to the
+// measured size, so the main thread never lays the text out: a new layout
+// costs a reference and a redraw.  Glyphs that aren't in the glyph cache
+// yet are still rasterized on the main thread the first time they're
+// painted.
+//
+// The text can't be edited or selected; for that, use ofxClutterText.
+class ofxClutterTextBlock : public ofxClutterActor {
+public:
+	ofxClutterTextBlock();
+	~ofxClutterTextBlock();
+	
+	void setLayout(const ofxClutterTextLayout& layout);
+	bool hasLayout() { return layout != NULL; }
+	
+	void setColor(int r, int g, int b, int a=255);
+	void setColor(const string& color);		// CSS/X11 name or #rrggbb[aa]
+	
+protected:
+	void paint();
+	static void onPaint(ClutterActor* actor, gpointer data);
+	
+	PangoLayout* layout;		// referenced
+	ClutterColor color;
+};
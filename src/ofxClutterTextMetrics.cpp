@@ -0,0 +1,113 @@
+/*
+ *  ofxClutterTextMetrics.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterTextMetrics.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+list<ofxClutterTextMetrics::Entry> ofxClutterTextMetrics::entries;
+map<string, list<ofxClutterTextMetrics::Entry>::iterator> ofxClutterTextMetrics::index;
+map<string, PangoLayout*> ofxClutterTextMetrics::layouts;
+int ofxClutterTextMetrics::maxEntries = 10000;
+int ofxClutterTextMetrics::numHits = 0;
+int ofxClutterTextMetrics::numMisses = 0;
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterTextMetrics::measure(string text, string font, int wrapWidth) {
+	return measure(text, font, wrapWidth, PANGO_WRAP_WORD, PANGO_ALIGN_LEFT, false);
+}
+
+
+//------------------------------------------------------------
+ofPoint ofxClutterTextMetrics::measure(string text, string font, int wrapWidth, PangoWrapMode wrapMode,
+									   PangoAlignment alignment, bool singleLine) {
+	if(wrapWidth < 0) wrapMode = PANGO_WRAP_WORD;		// doesn't matter, so don't split the cache on it
+	string style = font + "\n" + ofToString(wrapWidth) + " " + ofToString((int)wrapMode) + " "
+		+ ofToString((int)alignment) + " " + ofToString((int)singleLine);
+	string key = style + "\n" + text;
+	
+	map<string, list<Entry>::iterator>::iterator it = index.find(key);
+	if(it != index.end()) {
+		// Move to the front
+		entries.splice(entries.begin(), entries, it->second);
+		numHits++;
+		return it->second->size;
+	}
+	numMisses++;
+	
+	PangoLayout* layout = getLayout(style, font, wrapWidth, wrapMode, alignment, singleLine);
+	pango_layout_set_text(layout, text.c_str(), text.size());
+	int w, h;
+	pango_layout_get_pixel_size(layout, &w, &h);
+	
+	Entry entry;
+	entry.key = key;
+	entry.size = ofPoint(w, h);
+	entries.push_front(entry);
+	index[key] = entries.begin();
+	trim();
+	return entry.size;
+}
+
+
+//------------------------------------------------------------
+// Creating a layout means a new PangoLayout plus a font description lookup;
+// swapping the text on an existing one is much cheaper.  The layouts are
+// cleared rather than evicted if they pile up, since they're keyed by style
+// and apps only use a handful of those.
+PangoLayout* ofxClutterTextMetrics::getLayout(const string& style, string font, int wrapWidth, PangoWrapMode wrapMode,
+											  PangoAlignment alignment, bool singleLine) {
+	map<string, PangoLayout*>::iterator it = layouts.find(style);
+	if(it != layouts.end()) return it->second;
+	
+	if(layouts.size() >= 64) {
+		for(it = layouts.begin(); it != layouts.end(); ++it) g_object_unref(it->second);
+		layouts.clear();
+	}
+	PangoLayout* layout = pango_layout_new(clutter_actor_get_pango_context(stage));
+	PangoFontDescription* desc = pango_font_description_from_string(font.c_str());
+	pango_layout_set_font_description(layout, desc);
+	pango_font_description_free(desc);
+	if(wrapWidth >= 0) {
+		pango_layout_set_width(layout, wrapWidth * PANGO_SCALE);
+		pango_layout_set_wrap(layout, wrapMode);
+	}
+	pango_layout_set_alignment(layout, alignment);
+	pango_layout_set_single_paragraph_mode(layout, singleLine);
+	layouts[style] = layout;
+	return layout;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextMetrics::trim() {
+	while(entries.size() > maxEntries) {
+		index.erase(entries.back().key);
+		entries.pop_back();
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextMetrics::setMaxEntries(int n) {
+	maxEntries = MAX(n, 0);
+	trim();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextMetrics::clear() {
+	entries.clear();
+	index.clear();
+	for(map<string, PangoLayout*>::iterator it = layouts.begin(); it != layouts.end(); ++it) {
+		g_object_unref(it->second);
+	}
+	layouts.clear();
+}
@@ -0,0 +1,55 @@
+/*
+ *  ofxClutterTextMetrics.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include <clutter/clutter.h>
+
+
+// App-wide memo of "how big is this string in this font".  Results are
+// kept per (layout style, text) in a least recently used list of bounded
+// size; misses lay the text out through PangoLayouts that are themselves
+// cached per style.  The style is the font, the wrap width (-1 for none)
+// and mode, the alignment and single line mode.  Plain text only, no
+// markup, and no ellipsizing, which depends on the allocated width.
+//
+// Everything here is static and must be used from the main thread.
+class ofxClutterTextMetrics {
+public:
+	static ofPoint measure(string text, string font, int wrapWidth=-1);
+	static ofPoint measure(string text, string font, int wrapWidth, PangoWrapMode wrapMode,
+						   PangoAlignment alignment, bool singleLine);
+	static float getWidth(string text, string font) { return measure(text, font).x; }
+	static float getHeight(string text, string font, int wrapWidth=-1) { return measure(text, font, wrapWidth).y; }
+	
+	static void setMaxEntries(int n);
+	static int getMaxEntries() { return maxEntries; }
+	static int getNumEntries() { return entries.size(); }
+	
+	static int getNumHits() { return numHits; }
+	static int getNumMisses() { return numMisses; }
+	static void resetCounters() { numHits = numMisses = 0; }
+	
+	// Drop all results and layouts, e.g. after the font settings change
+	static void clear();
+	
+protected:
+	struct Entry {
+		string key;
+		ofPoint size;
+	};
+	
+	static PangoLayout* getLayout(const string& style, string font, int wrapWidth, PangoWrapMode wrapMode,
+								  PangoAlignment alignment, bool singleLine);
+	static void trim();
+	
+	static list<Entry> entries;					// most recently used first
+	static map<string, list<Entry>::iterator> index;
+	static map<string, PangoLayout*> layouts;
+	static int maxEntries;
+	static int numHits;
+	static int numMisses;
+};
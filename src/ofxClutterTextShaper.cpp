@@ -0,0 +1,176 @@
+/*
+ *  ofxClutterTextShaper.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterTextShaper.h"
+#include <pango/pangocairo.h>
+#include <cogl/cogl-pango.h>
+
+
+// Each worker thread gets its own context on its own font map.  It is a
+// Cogl Pango font map, like the one Clutter paints with, so the fonts and
+// metrics come out the same and the layouts can be painted with
+// cogl_pango_render_layout; creating one doesn't touch GL.
+static GPrivate* threadContext = NULL;
+
+// Held while creating font maps and loading fonts, which go through
+// fontconfig's shared configuration
+static GStaticMutex fontLock = G_STATIC_MUTEX_INIT;
+
+
+// Shapes one piece of text on a worker thread
+class ofxClutterShapeJob : public ofxClutterJob {
+public:
+	ofxClutterShapeJob(ofxClutterTextShaper* owner, int id, ofxClutterTextBlock* target)
+	: owner(owner), id(id), target(target) {
+		// Read the stage's settings here, on the main thread
+		ClutterBackend* backend = clutter_get_default_backend();
+		resolution = clutter_backend_get_resolution(backend);
+		const cairo_font_options_t* options = clutter_backend_get_font_options(backend);
+		fontOptions = options ? cairo_font_options_copy(options) : NULL;
+	}
+	
+	~ofxClutterShapeJob() {
+		if(fontOptions) cairo_font_options_destroy(fontOptions);
+	}
+	
+	void run() {
+		PangoContext* context = (PangoContext*)g_private_get(threadContext);
+		if(!context) {
+			g_static_mutex_lock(&fontLock);
+			PangoFontMap* fontMap = cogl_pango_font_map_new();
+			cogl_pango_font_map_set_resolution(COGL_PANGO_FONT_MAP(fontMap), resolution);
+			context = cogl_pango_font_map_create_context(COGL_PANGO_FONT_MAP(fontMap));
+			g_object_unref(fontMap);
+			g_static_mutex_unlock(&fontLock);
+			g_private_set(threadContext, context);
+		}
+		// Set on the context rather than the font map: layouts from earlier
+		// jobs may be painting from the font map on the main thread
+		if(pango_cairo_context_get_resolution(context) != resolution) {
+			pango_cairo_context_set_resolution(context, resolution);
+		}
+		if(fontOptions) pango_cairo_context_set_font_options(context, fontOptions);
+		
+		PangoFontDescription* desc = pango_font_description_from_string(layout.font.c_str());
+		g_static_mutex_lock(&fontLock);
+		PangoFont* primaryFont = pango_context_load_font(context, desc);
+		g_static_mutex_unlock(&fontLock);
+		
+		PangoLayout* pango = pango_layout_new(context);
+		pango_layout_set_font_description(pango, desc);
+		pango_font_description_free(desc);
+		if(layout.wrapWidth >= 0) {
+			pango_layout_set_width(pango, layout.wrapWidth * PANGO_SCALE);
+			pango_layout_set_wrap(pango, PANGO_WRAP_WORD);
+		}
+		if(layout.markup) pango_layout_set_markup(pango, layout.text.c_str(), layout.text.size());
+		else pango_layout_set_text(pango, layout.text.c_str(), layout.text.size());
+		
+		pango_layout_get_pixel_size(pango, &layout.width, &layout.height);
+		for(GSList* l = pango_layout_get_lines_readonly(pango); l; l = l->next) {
+			layout.lineStarts.push_back(((PangoLayoutLine*)l->data)->start_index);
+		}
+		layout.pango = pango;
+		if(primaryFont) g_object_unref(primaryFont);
+	}
+	
+	void finish() {
+		owner->layoutShaped(id, target, layout);
+	}
+	
+	ofxClutterTextShaper* owner;
+	int id;
+	ofxClutterTextBlock* target;
+	ofxClutterTextLayout layout;
+	double resolution;
+	cairo_font_options_t* fontOptions;
+};
+
+
+//------------------------------------------------------------
+ofxClutterTextLayout::ofxClutterTextLayout(const ofxClutterTextLayout& other) : pango(NULL) {
+	*this = other;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTextLayout& ofxClutterTextLayout::operator=(const ofxClutterTextLayout& other) {
+	if(other.pango) g_object_ref(other.pango);
+	if(pango) g_object_unref(pango);
+	text = other.text;
+	font = other.font;
+	wrapWidth = other.wrapWidth;
+	markup = other.markup;
+	width = other.width;
+	height = other.height;
+	lineStarts = other.lineStarts;
+	pango = other.pango;
+	return *this;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTextLayout::~ofxClutterTextLayout() {
+	if(pango) g_object_unref(pango);
+}
+
+
+//------------------------------------------------------------
+ofxClutterTextShaper::ofxClutterTextShaper(int numThreads) : pool(numThreads) {
+	if(!threadContext) threadContext = g_private_new(g_object_unref);
+	nextId = 0;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterTextShaper::shape(ofxClutterTextBlock* target, string text, string font, int wrapWidth, bool markup) {
+	int id = nextId++;
+	ofxClutterShapeJob* job = new ofxClutterShapeJob(this, id, target);
+	job->layout.text = text;
+	job->layout.font = font;
+	job->layout.wrapWidth = wrapWidth;
+	job->layout.markup = markup;
+	if(target) latest[target] = id;
+	pool.push(job);
+	return id;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextShaper::cancel(ofxClutterTextBlock* target) {
+	latest.erase(target);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterTextShaper::update(int maxMillis) {
+	return pool.finishJobs(-1, maxMillis);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTextShaper::layoutShaped(int id, ofxClutterTextBlock* target, ofxClutterTextLayout& layout) {
+	if(!target) {
+		results[id] = layout;
+		return;
+	}
+	
+	// Only the newest request for a target counts
+	map<ofxClutterTextBlock*, int>::iterator it = latest.find(target);
+	if(it == latest.end() || it->second != id) return;
+	latest.erase(it);
+	target->setLayout(layout);
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTextShaper::takeLayout(int id, ofxClutterTextLayout& layout) {
+	map<int, ofxClutterTextLayout>::iterator it = results.find(id);
+	if(it == results.end()) return false;
+	layout = it->second;
+	results.erase(it);
+	return true;
+}
@@ -0,0 +1,84 @@
+/*
+ *  ofxClutterTextShaper.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterTextBlock.h"
+#include "ofxClutterWorkerPool.h"
+
+
+// The result of shaping a piece of text: what was asked for, how big it
+// came out, and the shaped PangoLayout itself.  Made on a worker thread
+// and never changed afterwards; copies share the PangoLayout.
+class ofxClutterTextLayout {
+public:
+	ofxClutterTextLayout() : wrapWidth(-1), markup(false), width(0), height(0), pango(NULL) {}
+	ofxClutterTextLayout(const ofxClutterTextLayout& other);
+	ofxClutterTextLayout& operator=(const ofxClutterTextLayout& other);
+	~ofxClutterTextLayout();
+	
+	string text;
+	string font;
+	int wrapWidth;				// -1 for no wrapping
+	bool markup;
+	
+	int width, height;			// pixels
+	vector<int> lineStarts;		// byte offset into text of every line
+	
+	// Referenced.  Only read it; see ofxClutterTextBlock for painting it.
+	PangoLayout* pango;
+	
+	int getNumLines() const { return lineStarts.size(); }
+};
+
+
+// Shapes text on worker threads, so paragraphs can be shown without the
+// main thread laying them out.  Each thread has its own Cogl Pango font
+// map and context, set up with the same resolution and font options as the
+// stage, and the shaped PangoLayouts come back whole.
+//
+// Results come back in update().  Requests made with a target are applied
+// to it there with ofxClutterTextBlock::setLayout(), which paints the
+// worker's layout as it is; a newer request for the same target replaces
+// an older one that hasn't finished yet.
+//
+// Threads: Pango 1.28 isn't thread safe, and neither is the fontconfig it
+// loads fonts through.  Separate font maps per thread still share the one
+// FcConfig, so font maps are created one at a time and each job loads the
+// fonts for its font description under the same lock before shaping.
+// Fallback fonts for characters the main font lacks are still loaded
+// while shaping, unlocked; shape text that needs them with a single thread
+// (ofxClutterTextShaper(1)) if that turns out to be a problem.  Each
+// thread's font map also has its own glyph cache, which
+// ofxClutterText::preloadFont() doesn't fill.
+class ofxClutterTextShaper {
+public:
+	ofxClutterTextShaper(int numThreads=0);
+	
+	// Returns a request id
+	int shape(ofxClutterTextBlock* target, string text, string font, int wrapWidth=-1, bool markup=false);
+	int shape(string text, string font, int wrapWidth=-1, bool markup=false) { return shape(NULL, text, font, wrapWidth, markup); }
+	
+	// Forget pending work for a target, e.g. before deleting it
+	void cancel(ofxClutterTextBlock* target);
+	
+	// Applies finished results; call every frame
+	int update(int maxMillis=-1);
+	
+	// Results of requests without a target, kept until taken
+	bool isReady(int id) { return results.find(id) != results.end(); }
+	bool takeLayout(int id, ofxClutterTextLayout& layout);
+	
+	int getNumPending() { return pool.getNumPending(); }
+	
+	// Called by the shaping jobs
+	void layoutShaped(int id, ofxClutterTextBlock* target, ofxClutterTextLayout& layout);
+	
+protected:
+	ofxClutterWorkerPool pool;
+	int nextId;
+	map<ofxClutterTextBlock*, int> latest;
+	map<int, ofxClutterTextLayout> results;
+};
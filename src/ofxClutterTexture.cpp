@@ -8,6 +8,10 @@
  */
 
 #include "ofxClutterTexture.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 // We need access to the stage
 extern "C" {
@@ -15,9 +19,517 @@ extern "C" {
 };
 
 
+string ofxClutterTexture::cacheDirectory;
+
+// Layout of a decoded-image cache file: this header, then height rows of
+// rowstride bytes in the given CoglPixelFormat, ready for cogl_texture_new_from_data.
+struct ofxClutterTextureCacheHeader {
+	char magic[8];
+	gint64 sourceMTime;
+	gint64 sourceSize;
+	gint32 width;
+	gint32 height;
+	gint32 rowstride;
+	gint32 format;
+};
+static const char cacheMagic[8] = { 'O','F','X','C','T','E','X','1' };
+
+// BT.601 video-range YUV -> RGB.  Every plane is uploaded as an alpha-only
+// texture, so each sample is in .a.  gl_Color carries the (premultiplied)
+// paint opacity from ClutterTexture.
+#define YUV_TO_RGB_GLSL \
+	"  y = 1.1643 * (y - 0.0625);\n" \
+	"  u = u - 0.5;\n" \
+	"  v = v - 0.5;\n" \
+	"  vec3 rgb = vec3(y + 1.5958 * v,\n" \
+	"                  y - 0.39173 * u - 0.81290 * v,\n" \
+	"                  y + 2.017 * u);\n" \
+	"  gl_FragColor = vec4(rgb, 1.0) * gl_Color;\n"
+
+static const char* i420Shader =
+	"uniform sampler2D ytex;\n"
+	"uniform sampler2D utex;\n"
+	"uniform sampler2D vtex;\n"
+	"void main() {\n"
+	"  vec2 st = gl_TexCoord[0].st;\n"
+	"  float y = texture2D(ytex, st).a;\n"
+	"  float u = texture2D(utex, st).a;\n"
+	"  float v = texture2D(vtex, st).a;\n"
+	YUV_TO_RGB_GLSL
+	"}\n";
+
+// The UV plane is one byte per texel, w wide and h/2 high, sampled with
+// GL_NEAREST so U and V can be picked out of each pair.
+static const char* nv12Shader =
+	"uniform sampler2D ytex;\n"
+	"uniform sampler2D uvtex;\n"
+	"uniform float width;\n"
+	"void main() {\n"
+	"  vec2 st = gl_TexCoord[0].st;\n"
+	"  float pair = floor(st.x * width * 0.5);\n"
+	"  float y = texture2D(ytex, st).a;\n"
+	"  float u = texture2D(uvtex, vec2((pair * 2.0 + 0.5) / width, st.t)).a;\n"
+	"  float v = texture2D(uvtex, vec2((pair * 2.0 + 1.5) / width, st.t)).a;\n"
+	YUV_TO_RGB_GLSL
+	"}\n";
+
+// The whole frame is one byte per texel, 2w wide.  Every 4 texels hold U Y0 V Y1.
+static const char* uyvyShader =
+	"uniform sampler2D tex;\n"
+	"uniform float width;\n"
+	"void main() {\n"
+	"  vec2 st = gl_TexCoord[0].st;\n"
+	"  float px = floor(st.x * width);\n"
+	"  float pair = floor(px * 0.5);\n"
+	"  float odd = px - pair * 2.0;\n"
+	"  float texels = width * 2.0;\n"
+	"  float u = texture2D(tex, vec2((pair * 4.0 + 0.5) / texels, st.t)).a;\n"
+	"  float y = texture2D(tex, vec2((pair * 4.0 + 1.5 + odd * 2.0) / texels, st.t)).a;\n"
+	"  float v = texture2D(tex, vec2((pair * 4.0 + 2.5) / texels, st.t)).a;\n"
+	YUV_TO_RGB_GLSL
+	"}\n";
+
+
+//------------------------------------------------------------
+// One linked program per format and frame width, shared by every texture.
+// The width is baked in as a uniform because the packed formats need it to
+// find their texels, and uniforms belong to the program, not the material.
+static CoglHandle getYUVProgram(ofxClutterYUVFormat format, int width) {
+	static map<pair<int,int>, CoglHandle> programs;
+	pair<int,int> key(format, (format==OFX_CLUTTER_YUV_I420) ? 0 : width);
+	map<pair<int,int>, CoglHandle>::iterator it = programs.find(key);
+	if(it != programs.end()) return it->second;
+	
+	const char* source = (format==OFX_CLUTTER_YUV_I420) ? i420Shader :
+						 (format==OFX_CLUTTER_YUV_NV12) ? nv12Shader : uyvyShader;
+	
+	CoglHandle shader = cogl_create_shader(COGL_SHADER_TYPE_FRAGMENT);
+	cogl_shader_source(shader, source);
+	cogl_shader_compile(shader);
+	if(!cogl_shader_is_compiled(shader)) {
+		char* log = cogl_shader_get_info_log(shader);
+		ofLog(OF_LOG_ERROR, "ofxClutterTexture: YUV shader didn't compile.");
+		fprintf (stderr, "%s\n", log);
+		g_free(log);
+		cogl_handle_unref(shader);
+		return COGL_INVALID_HANDLE;
+	}
+	
+	CoglHandle program = cogl_create_program();
+	cogl_program_attach_shader(program, shader);
+	cogl_program_link(program);
+	cogl_handle_unref(shader);
+	
+	// Samplers are bound to material layers in order
+	const char* samplers[3] = { (format==OFX_CLUTTER_YUV_UYVY) ? "tex" : "ytex",
+								(format==OFX_CLUTTER_YUV_NV12) ? "uvtex" : "utex",
+								"vtex" };
+	for(int i=0; i<3; i++) {
+		int location = cogl_program_get_uniform_location(program, samplers[i]);
+		if(location >= 0) cogl_program_set_uniform_1i(program, location, i);
+	}
+	int location = cogl_program_get_uniform_location(program, "width");
+	if(location >= 0) cogl_program_set_uniform_1f(program, location, width);
+	
+	programs[key] = program;
+	return program;
+}
+
+
 //------------------------------------------------------------
 ofxClutterTexture::ofxClutterTexture() {
 	actor = clutter_texture_new();
 	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
 	clutter_actor_show(actor);
+	
+	texWidth = texHeight = texBpp = 0;
+	fullUploadThreshold = 0.5;
+	numRegionsUploaded = numPixelsUploaded = 0;
+	
+	yuvFormat = OFX_CLUTTER_YUV_NONE;
+	yuvPlanes[0] = yuvPlanes[1] = yuvPlanes[2] = COGL_INVALID_HANDLE;
+	yuvWidth = yuvHeight = 0;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTexture::loadImage(string path) {
+	path = ofToDataPath(path, true);
+	ofLog(OF_LOG_VERBOSE, "ofxClutterTexture: loading " + path);
+	
+	if(yuvFormat != OFX_CLUTTER_YUV_NONE) {
+		releaseYUV();
+	}
+	texWidth = texHeight = texBpp = 0;
+	dirtyRects.clear();
+	
+	if(!cacheDirectory.empty() && loadFromCache(path)) {
+		return true;
+	}
+	
+	GError *error=NULL;
+	bool success;
+	success = clutter_texture_set_from_file(CLUTTER_TEXTURE(actor), path.c_str(), &error);
+	if(!success) {
+		ofLog(OF_LOG_ERROR, "Couldn't load image.");
+		fprintf (stderr, "Unable to read file: %s\n", error->message);
+		g_error_free(error);
+		return false;
+	}
+	
+	if(!cacheDirectory.empty()) {
+		saveToCache(path);
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTexture::setCacheDirectory(string dir) {
+	if(dir.empty()) {
+		cacheDirectory = "";
+		return;
+	}
+	dir = ofToDataPath(dir, true);
+	if(g_mkdir_with_parents(dir.c_str(), 0755) != 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTexture: couldn't create cache directory " + dir);
+		cacheDirectory = "";
+		return;
+	}
+	cacheDirectory = dir;
+}
+
+
+//------------------------------------------------------------
+// The cache file name is the image name plus a 64 bit FNV-1a hash of the
+// full path, so images with the same name in different folders don't collide.
+static string getCachePath(string dir, string path) {
+	guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+	for(int i=0; i<path.size(); i++) {
+		hash ^= (unsigned char)path[i];
+		hash *= G_GUINT64_CONSTANT(1099511628211);
+	}
+	char* base = g_path_get_basename(path.c_str());
+	char* name = g_strdup_printf("%s-%016" G_GINT64_MODIFIER "x.tex", base, hash);
+	string cachePath = dir + "/" + name;
+	g_free(name);
+	g_free(base);
+	return cachePath;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTexture::loadFromCache(string path) {
+	struct stat source;
+	if(stat(path.c_str(), &source) != 0) return false;
+	
+	int fd = open(getCachePath(cacheDirectory, path).c_str(), O_RDONLY);
+	if(fd < 0) return false;
+	
+	struct stat cached;
+	if(fstat(fd, &cached) != 0 || cached.st_size < (off_t)sizeof(ofxClutterTextureCacheHeader)) {
+		close(fd);
+		return false;
+	}
+	
+	void* mapped = mmap(NULL, cached.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) return false;
+	
+	// A stale entry (source edited since) is simply ignored; saveToCache() overwrites it.
+	const ofxClutterTextureCacheHeader* header = (const ofxClutterTextureCacheHeader*)mapped;
+	bool valid = memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) == 0
+				&& header->sourceMTime == (gint64)source.st_mtime
+				&& header->sourceSize == (gint64)source.st_size
+				&& header->width > 0 && header->height > 0
+				&& cached.st_size >= (off_t)(sizeof(ofxClutterTextureCacheHeader) + (gint64)header->rowstride * header->height);
+	
+	bool success = false;
+	if(valid) {
+		const guint8* data = (const guint8*)mapped + sizeof(ofxClutterTextureCacheHeader);
+		CoglHandle tex = cogl_texture_new_from_data(header->width, header->height, COGL_TEXTURE_NONE,
+													(CoglPixelFormat)header->format, COGL_PIXEL_FORMAT_ANY,
+													header->rowstride, data);
+		if(tex != COGL_INVALID_HANDLE) {
+			clutter_texture_set_cogl_texture(CLUTTER_TEXTURE(actor), tex);
+			cogl_handle_unref(tex);
+			success = true;
+		}
+	}
+	munmap(mapped, cached.st_size);
+	return success;
+}
+
+
+//------------------------------------------------------------
+// Reads the freshly decoded texture back and writes it out next to a header.
+// Only happens on a cache miss, so the readback cost is paid once per image.
+void ofxClutterTexture::saveToCache(string path) {
+	struct stat source;
+	if(stat(path.c_str(), &source) != 0) return;
+	
+	CoglHandle tex = clutter_texture_get_cogl_texture(CLUTTER_TEXTURE(actor));
+	if(tex == COGL_INVALID_HANDLE) return;
+	
+	ofxClutterTextureCacheHeader header;
+	memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.sourceMTime = source.st_mtime;
+	header.sourceSize = source.st_size;
+	header.width = cogl_texture_get_width(tex);
+	header.height = cogl_texture_get_height(tex);
+	
+	// Opaque images are stored without alpha to keep the files small
+	bool hasAlpha = (cogl_texture_get_format(tex) & COGL_A_BIT) != 0;
+	header.format = hasAlpha ? COGL_PIXEL_FORMAT_RGBA_8888_PRE : COGL_PIXEL_FORMAT_RGB_888;
+	header.rowstride = header.width * (hasAlpha ? 4 : 3);
+	
+	int size = header.rowstride * header.height;
+	guint8* data = (guint8*)g_malloc(size);
+	cogl_texture_get_data(tex, (CoglPixelFormat)header.format, header.rowstride, data);
+	
+	// Write to a temporary name and rename, so a crash never leaves a truncated entry
+	string cachePath = getCachePath(cacheDirectory, path);
+	string tmpPath = cachePath + ".tmp";
+	FILE* f = fopen(tmpPath.c_str(), "wb");
+	if(f) {
+		bool written = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(data, size, 1, f) == 1;
+		written = (fclose(f) == 0) && written;
+		if(!written || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+			ofLog(OF_LOG_WARNING, "ofxClutterTexture: couldn't write cache file " + cachePath);
+			unlink(tmpPath.c_str());
+		}
+	}
+	g_free(data);
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTexture::setFromPixels(const unsigned char* pixels, int w, int h, int bpp) {
+	if(bpp != 3 && bpp != 4) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTexture: only RGB and RGBA pixels can be uploaded.");
+		return false;
+	}
+	
+	// Drop the YUV material so the new texture isn't run through the shader
+	if(yuvFormat != OFX_CLUTTER_YUV_NONE) {
+		releaseYUV();
+	}
+	
+	GError *error=NULL;
+	bool success = clutter_texture_set_from_rgb_data(CLUTTER_TEXTURE(actor), pixels, bpp==4,
+													 w, h, w*bpp, bpp, CLUTTER_TEXTURE_NONE, &error);
+	if(!success) {
+		ofLog(OF_LOG_ERROR, "Couldn't upload pixels.");
+		fprintf (stderr, "Unable to upload pixels: %s\n", error->message);
+		g_error_free(error);
+		return false;
+	}
+	
+	texWidth = w;
+	texHeight = h;
+	texBpp = bpp;
+	dirtyRects.clear();
+	numRegionsUploaded = 1;
+	numPixelsUploaded = w*h;
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTexture::addDirtyRect(int x, int y, int w, int h) {
+	// Clip to the texture; anything outside it can't be uploaded anyway.
+	int x2 = MIN(x+w, texWidth);
+	int y2 = MIN(y+h, texHeight);
+	x = MAX(x, 0);
+	y = MAX(y, 0);
+	if(x2 <= x || y2 <= y) return;
+	
+	dirtyRects.push_back( ofRectangle(x, y, x2-x, y2-y) );
+}
+
+
+//------------------------------------------------------------
+// Merge any two rects whose bounding box is not much bigger than the
+// two of them separately.  One larger upload is cheaper than several
+// small ones, as long as we aren't re-sending lots of unchanged pixels.
+void ofxClutterTexture::coalesceDirtyRects() {
+	bool merged = true;
+	while(merged) {
+		merged = false;
+		for(int i=0; i<dirtyRects.size() && !merged; i++) {
+			for(int j=i+1; j<dirtyRects.size(); j++) {
+				ofRectangle& a = dirtyRects[i];
+				ofRectangle& b = dirtyRects[j];
+				float x1 = MIN(a.x, b.x);
+				float y1 = MIN(a.y, b.y);
+				float x2 = MAX(a.x+a.width, b.x+b.width);
+				float y2 = MAX(a.y+a.height, b.y+b.height);
+				float unionArea = (x2-x1) * (y2-y1);
+				if(unionArea <= (a.width*a.height + b.width*b.height) * 1.25) {
+					a = ofRectangle(x1, y1, x2-x1, y2-y1);
+					dirtyRects.erase(dirtyRects.begin()+j);
+					merged = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTexture::updatePixels(const unsigned char* pixels) {
+	numRegionsUploaded = numPixelsUploaded = 0;
+	if(texWidth==0 || texHeight==0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTexture: call setFromPixels() before updatePixels().");
+		return false;
+	}
+	if(dirtyRects.empty()) return true;
+	
+	coalesceDirtyRects();
+	
+	float dirtyArea = 0;
+	for(int i=0; i<dirtyRects.size(); i++) {
+		dirtyArea += dirtyRects[i].width * dirtyRects[i].height;
+	}
+	if(dirtyArea / (texWidth*texHeight) > fullUploadThreshold) {
+		return setFromPixels(pixels, texWidth, texHeight, texBpp);
+	}
+	
+	int rowstride = texWidth * texBpp;
+	for(int i=0; i<dirtyRects.size(); i++) {
+		int x = dirtyRects[i].x;
+		int y = dirtyRects[i].y;
+		int w = dirtyRects[i].width;
+		int h = dirtyRects[i].height;
+		
+		// Point at the first pixel of the region and keep the full rowstride,
+		// so the source doesn't need to be copied out.
+		GError *error=NULL;
+		bool success = clutter_texture_set_area_from_rgb_data(CLUTTER_TEXTURE(actor),
+															  pixels + y*rowstride + x*texBpp, texBpp==4,
+															  x, y, w, h, rowstride, texBpp,
+															  CLUTTER_TEXTURE_NONE, &error);
+		if(!success) {
+			ofLog(OF_LOG_ERROR, "Couldn't upload dirty region.");
+			fprintf (stderr, "Unable to upload region: %s\n", error->message);
+			g_error_free(error);
+			dirtyRects.clear();
+			return false;
+		}
+		numRegionsUploaded++;
+		numPixelsUploaded += w*h;
+	}
+	dirtyRects.clear();
+	return true;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTexture::releaseYUV() {
+	for(int i=0; i<3; i++) {
+		if(yuvPlanes[i] != COGL_INVALID_HANDLE) {
+			cogl_handle_unref(yuvPlanes[i]);
+			yuvPlanes[i] = COGL_INVALID_HANDLE;
+		}
+	}
+	
+	CoglMaterial* material = cogl_material_new();
+	clutter_texture_set_cogl_material(CLUTTER_TEXTURE(actor), material);
+	cogl_handle_unref(material);
+	
+	yuvFormat = OFX_CLUTTER_YUV_NONE;
+	yuvWidth = yuvHeight = 0;
+}
+
+
+//------------------------------------------------------------
+// Creates the plane textures and a material that samples them through the
+// conversion shader.  Only called when the frame size or format changes.
+bool ofxClutterTexture::allocateYUV(int w, int h, ofxClutterYUVFormat format) {
+	CoglHandle program = getYUVProgram(format, w);
+	if(program == COGL_INVALID_HANDLE) return false;
+	
+	releaseYUV();
+	
+	// Each plane: size in texels, and whether it holds interleaved
+	// samples that must not be blended together.
+	int planeW[3], planeH[3], numPlanes;
+	bool interleaved[3] = { false, false, false };
+	if(format == OFX_CLUTTER_YUV_I420) {
+		numPlanes = 3;
+		planeW[0] = w;		planeH[0] = h;
+		planeW[1] = w/2;	planeH[1] = h/2;
+		planeW[2] = w/2;	planeH[2] = h/2;
+	}
+	else if(format == OFX_CLUTTER_YUV_NV12) {
+		numPlanes = 2;
+		planeW[0] = w;		planeH[0] = h;
+		planeW[1] = w;		planeH[1] = h/2;
+		interleaved[1] = true;
+	}
+	else {
+		numPlanes = 1;
+		planeW[0] = w*2;	planeH[0] = h;
+		interleaved[0] = true;
+	}
+	
+	// No atlas or slicing: the shader addresses texels directly
+	CoglTextureFlags flags = (CoglTextureFlags)(COGL_TEXTURE_NO_AUTO_MIPMAP | COGL_TEXTURE_NO_SLICING | COGL_TEXTURE_NO_ATLAS);
+	CoglMaterial* material = cogl_material_new();
+	for(int i=0; i<numPlanes; i++) {
+		yuvPlanes[i] = cogl_texture_new_with_size(planeW[i], planeH[i], flags, COGL_PIXEL_FORMAT_A_8);
+		if(yuvPlanes[i] == COGL_INVALID_HANDLE) {
+			ofLog(OF_LOG_ERROR, "ofxClutterTexture: couldn't allocate YUV plane textures.");
+			cogl_handle_unref(material);
+			releaseYUV();
+			return false;
+		}
+		cogl_material_set_layer(material, i, yuvPlanes[i]);
+		if(interleaved[i]) {
+			cogl_material_set_layer_filters(material, i, COGL_MATERIAL_FILTER_NEAREST, COGL_MATERIAL_FILTER_NEAREST);
+		}
+	}
+	cogl_material_set_user_program(material, program);
+	
+	clutter_texture_set_cogl_material(CLUTTER_TEXTURE(actor), material);
+	cogl_handle_unref(material);
+	
+	// Layer 0 is twice as wide as the picture for packed formats
+	if(format == OFX_CLUTTER_YUV_UYVY) {
+		clutter_actor_set_size(actor, w, h);
+	}
+	
+	yuvFormat = format;
+	yuvWidth = w;
+	yuvHeight = h;
+	return true;
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTexture::setFromYUV(const unsigned char* data, int w, int h, ofxClutterYUVFormat format) {
+	if(format == OFX_CLUTTER_YUV_NONE || w <= 0 || h <= 0 || w%2 || h%2) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTexture: YUV frames need a format and even dimensions.");
+		return false;
+	}
+	
+	if(format != yuvFormat || w != yuvWidth || h != yuvHeight) {
+		if(!allocateYUV(w, h, format)) return false;
+	}
+	
+	// Sub-uploads into the existing planes; the material stays as it is.
+	const unsigned char* plane = data;
+	for(int i=0; i<3 && yuvPlanes[i] != COGL_INVALID_HANDLE; i++) {
+		int pw = cogl_texture_get_width(yuvPlanes[i]);
+		int ph = cogl_texture_get_height(yuvPlanes[i]);
+		cogl_texture_set_region(yuvPlanes[i], 0, 0, 0, 0, pw, ph, pw, ph,
+								COGL_PIXEL_FORMAT_A_8, pw, plane);
+		plane += pw*ph;
+	}
+	
+	texWidth = texHeight = texBpp = 0;
+	dirtyRects.clear();
+	clutter_actor_queue_redraw(actor);
+	return true;
 }
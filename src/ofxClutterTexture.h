@@ -10,22 +10,70 @@
 #pragma once
 #include "ofxClutterActor.h"
 
+// Raw video frame layouts accepted by ofxClutterTexture::setFromYUV()
+enum ofxClutterYUVFormat {
+	OFX_CLUTTER_YUV_NONE,
+	OFX_CLUTTER_YUV_I420,		// planar: Y, then U and V at half width and height
+	OFX_CLUTTER_YUV_NV12,		// Y plane, then interleaved UV at half height
+	OFX_CLUTTER_YUV_UYVY		// packed 4:2:2, U Y0 V Y1 for every two pixels
+};
 
 class ofxClutterTexture : public ofxClutterActor {
 public:
 	ofxClutterTexture();
 	
-	bool loadImage(string path) {
-		path = ofToDataPath(path, true);
-		cout << "loading: " << path << endl;
-		GError *error=NULL;
-		bool success;
-		success = clutter_texture_set_from_file(CLUTTER_TEXTURE(actor), path.c_str(), &error);
-		if(!success) {
-			ofLog(OF_LOG_ERROR, "Couldn't load image.");
-			fprintf (stderr, "Unable to read file: %s\n", error->message);
-			return false;
-		}
-		return true;
-	}
-};
\ No newline at end of file
+	bool loadImage(string path);
+	
+	// Optional cache of decoded images.  When set, loadImage() keeps a raw
+	// copy of each decoded image in this directory, keyed by the source path,
+	// modification time and size, and later loads mmap it and upload it
+	// directly instead of decoding the file again.  Pass "" to turn it off.
+	static void setCacheDirectory(string dir);
+	static string getCacheDirectory() { return cacheDirectory; }
+	
+	// Uploads the whole image.  Pixels are tightly packed RGB (bpp=3) or RGBA (bpp=4).
+	bool setFromPixels(const unsigned char* pixels, int w, int h, int bpp);
+	
+	// Partial updates: mark the regions that changed since the last upload,
+	// then call updatePixels() once per frame with the full source image.
+	// Overlapping and neighbouring rects are merged, and if they cover more
+	// than the threshold fraction of the texture it does one full upload instead.
+	void addDirtyRect(int x, int y, int w, int h);
+	void addDirtyRect(ofRectangle r) { addDirtyRect(r.x, r.y, r.width, r.height); }
+	void clearDirtyRects() { dirtyRects.clear(); }
+	bool updatePixels(const unsigned char* pixels);
+	bool updatePixels(ofImage& img) { return updatePixels(img.getPixels()); }
+	
+	void setFullUploadThreshold(float coverage) { fullUploadThreshold = coverage; }
+	float getFullUploadThreshold() { return fullUploadThreshold; }
+	
+	// Uploads a YUV video frame.  The planes go up untouched as alpha-only
+	// textures and a fragment shader on the texture's material converts them
+	// to RGB (BT.601), so there is no per-pixel work on the CPU.  Frames of the
+	// same size and format reuse the plane textures.  Width and height must be even.
+	bool setFromYUV(const unsigned char* data, int w, int h, ofxClutterYUVFormat format);
+	ofxClutterYUVFormat getYUVFormat() { return yuvFormat; }
+	
+	// Upload counters for the last updatePixels() call
+	int getNumRegionsUploaded() { return numRegionsUploaded; }
+	int getNumPixelsUploaded() { return numPixelsUploaded; }
+	
+protected:
+	void coalesceDirtyRects();
+	bool loadFromCache(string path);
+	void saveToCache(string path);
+	bool allocateYUV(int w, int h, ofxClutterYUVFormat format);
+	void releaseYUV();
+	
+	int texWidth, texHeight, texBpp;
+	float fullUploadThreshold;
+	vector<ofRectangle> dirtyRects;
+	int numRegionsUploaded;
+	int numPixelsUploaded;
+	
+	ofxClutterYUVFormat yuvFormat;
+	CoglHandle yuvPlanes[3];
+	int yuvWidth, yuvHeight;
+	
+	static string cacheDirectory;
+};
@@ -0,0 +1,331 @@
+/*
+ *  ofxClutterTiledImage.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterTiledImage.h"
+#include <float.h>
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+
+// Decodes one tile file on a worker thread
+class ofxClutterTileLoadJob : public ofxClutterJob {
+public:
+	ofxClutterTileLoadJob(ofxClutterTiledImage* owner, int generation, gint64 key, string path)
+	: owner(owner), generation(generation), key(key), path(path), success(false) {}
+	
+	void run() {
+		img.setUseTexture(false);
+		success = img.loadImage(path);
+	}
+	
+	void finish() {
+		owner->tileLoaded(generation, key, img, success);
+	}
+	
+	ofxClutterTiledImage* owner;
+	int generation;
+	gint64 key;
+	string path;
+	ofImage img;
+	bool success;
+};
+
+
+//------------------------------------------------------------
+ofxClutterTiledImage::ofxClutterTiledImage() {
+	actor = clutter_group_new();
+	clutter_container_add_actor(CLUTTER_CONTAINER(stage), actor);
+	clutter_actor_show(actor);
+	
+	imageWidth = imageHeight = 0;
+	tileSize = 0;
+	numLevels = 0;
+	currentLevel = 0;
+	generation = 0;
+	frame = 0;
+	maxCachedTiles = 256;
+	maxUploadsPerFrame = 4;
+	maxPendingTiles = pool.getNumThreads() * 4;
+}
+
+
+//------------------------------------------------------------
+ofxClutterTiledImage::~ofxClutterTiledImage() {
+	// Takes all the tile textures with it
+	clutter_actor_destroy(actor);
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTiledImage::buildPyramid(string source, string dir, int tileSize) {
+	ofImage img;
+	img.setUseTexture(false);
+	if(!img.loadImage(source)) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTiledImage: couldn't load " + source);
+		return false;
+	}
+	if(img.type == OF_IMAGE_GRAYSCALE) {
+		img.setImageType(OF_IMAGE_COLOR);
+	}
+	
+	dir = ofToDataPath(dir, true);
+	if(g_mkdir_with_parents(dir.c_str(), 0755) != 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTiledImage: couldn't create " + dir);
+		return false;
+	}
+	
+	int w = img.width;
+	int h = img.height;
+	int bpp = img.bpp / 8;
+	int type = (bpp == 4) ? OF_IMAGE_COLOR_ALPHA : OF_IMAGE_COLOR;
+	string extension = (bpp == 4) ? "png" : "jpg";
+	
+	int numLevels = 1;
+	while((tileSize << (numLevels-1)) < MAX(w, h)) numLevels++;
+	
+	// Work from the full image down, halving as we go
+	vector<unsigned char> level(img.getPixels(), img.getPixels() + w*h*bpp);
+	vector<unsigned char> tile(tileSize*tileSize*bpp);
+	int lw = w;
+	int lh = h;
+	for(int l=numLevels-1; l>=0; l--) {
+		string levelDir = dir + "/" + ofToString(l);
+		g_mkdir_with_parents(levelDir.c_str(), 0755);
+		
+		for(int row=0; row*tileSize < lh; row++) {
+			for(int col=0; col*tileSize < lw; col++) {
+				int tw = MIN(tileSize, lw - col*tileSize);
+				int th = MIN(tileSize, lh - row*tileSize);
+				for(int y=0; y<th; y++) {
+					memcpy(&tile[y*tw*bpp], &level[((row*tileSize + y)*lw + col*tileSize)*bpp], tw*bpp);
+				}
+				ofImage out;
+				out.setUseTexture(false);
+				out.setFromPixels(&tile[0], tw, th, type);
+				out.saveImage(levelDir + "/" + ofToString(col) + "_" + ofToString(row) + "." + extension);
+			}
+		}
+		
+		if(l > 0) {
+			// 2x2 box filter; odd edges repeat the last row/column
+			int nw = (lw+1) / 2;
+			int nh = (lh+1) / 2;
+			vector<unsigned char> next(nw*nh*bpp);
+			for(int y=0; y<nh; y++) {
+				int y0 = y*2;
+				int y1 = MIN(y0+1, lh-1);
+				for(int x=0; x<nw; x++) {
+					int x0 = x*2;
+					int x1 = MIN(x0+1, lw-1);
+					for(int c=0; c<bpp; c++) {
+						int sum = level[(y0*lw + x0)*bpp + c] + level[(y0*lw + x1)*bpp + c]
+								+ level[(y1*lw + x0)*bpp + c] + level[(y1*lw + x1)*bpp + c];
+						next[(y*nw + x)*bpp + c] = (sum + 2) / 4;
+					}
+				}
+			}
+			level.swap(next);
+			lw = nw;
+			lh = nh;
+		}
+	}
+	
+	ofstream info((dir + "/pyramid.txt").c_str());
+	info << w << " " << h << " " << tileSize << " " << numLevels << " " << extension << endl;
+	return info.good();
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTiledImage::load(string dir) {
+	dir = ofToDataPath(dir, true);
+	ifstream info((dir + "/pyramid.txt").c_str());
+	int w=0, h=0, size=0, levels=0;
+	string ext;
+	info >> w >> h >> size >> levels >> ext;
+	if(!info || w <= 0 || h <= 0 || size <= 0 || levels <= 0) {
+		ofLog(OF_LOG_ERROR, "ofxClutterTiledImage: no pyramid in " + dir + ", see buildPyramid()");
+		return false;
+	}
+	
+	// Throw away the previous image; its jobs will be ignored when they finish
+	for(int i=0; i<levelGroups.size(); i++) {
+		clutter_actor_destroy(levelGroups[i]);
+	}
+	levelGroups.clear();
+	tiles.clear();
+	generation++;
+	
+	this->dir = dir;
+	extension = ext;
+	imageWidth = w;
+	imageHeight = h;
+	tileSize = size;
+	numLevels = levels;
+	currentLevel = 0;
+	
+	// One group per level, scaled up to full image coordinates, finer levels on top
+	for(int l=0; l<numLevels; l++) {
+		ClutterActor* group = clutter_group_new();
+		float scale = 1 << (numLevels-1-l);
+		clutter_actor_set_scale(group, scale, scale);
+		clutter_container_add_actor(CLUTTER_CONTAINER(actor), group);
+		clutter_actor_show(group);
+		levelGroups.push_back(group);
+	}
+	clutter_actor_set_size(actor, imageWidth, imageHeight);
+	return true;
+}
+
+
+//------------------------------------------------------------
+string ofxClutterTiledImage::tilePath(int level, int col, int row) {
+	return dir + "/" + ofToString(level) + "/" + ofToString(col) + "_" + ofToString(row) + "." + extension;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTiledImage::update() {
+	if(numLevels == 0) return;
+	frame++;
+	
+	pool.finishJobs(maxUploadsPerFrame);
+	
+	// Which part of the image is on stage, in full resolution pixels
+	gfloat sw, sh;
+	clutter_actor_get_size(stage, &sw, &sh);
+	gfloat corners[4][2] = { {0,0}, {sw,0}, {0,sh}, {sw,sh} };
+	float x1=FLT_MAX, y1=FLT_MAX, x2=-FLT_MAX, y2=-FLT_MAX;
+	for(int i=0; i<4; i++) {
+		gfloat x, y;
+		if(!clutter_actor_transform_stage_point(actor, corners[i][0], corners[i][1], &x, &y)) return;
+		x1 = MIN(x1, x);	y1 = MIN(y1, y);
+		x2 = MAX(x2, x);	y2 = MAX(y2, y);
+	}
+	
+	// Coarsest level that still has at least one texel per screen pixel
+	float imagePerScreen = MAX((x2-x1) / sw, (y2-y1) / sh);
+	int level = numLevels-1;
+	while(level > 0 && (1 << (numLevels-level)) <= imagePerScreen) level--;
+	currentLevel = level;
+	
+	// Level 0 is always kept as the backdrop
+	requestTile(0, 0, 0);
+	
+	x1 = MAX(x1, 0);	y1 = MAX(y1, 0);
+	x2 = MIN(x2, imageWidth);	y2 = MIN(y2, imageHeight);
+	if(x2 > x1 && y2 > y1) {
+		int span = tileSize << (numLevels-1-level);
+		for(int row=y1/span; row*span < y2; row++) {
+			for(int col=x1/span; col*span < x2; col++) {
+				requestTile(level, col, row);
+				map<gint64, Tile>::iterator it = tiles.find(tileKey(level, col, row));
+				if(it == tiles.end() || !it->second.texture) {
+					showCoarserTile(level, col, row);
+				}
+			}
+		}
+	}
+	
+	for(map<gint64, Tile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+		if(!it->second.texture) continue;
+		if(it->second.lastUsed == frame) clutter_actor_show(it->second.texture);
+		else clutter_actor_hide(it->second.texture);
+	}
+	
+	evictTiles();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTiledImage::requestTile(int level, int col, int row) {
+	gint64 key = tileKey(level, col, row);
+	map<gint64, Tile>::iterator it = tiles.find(key);
+	if(it != tiles.end()) {
+		it->second.lastUsed = frame;
+		return;
+	}
+	
+	// Don't let a fast pan queue up work for tiles that are long gone;
+	// anything skipped is asked for again next frame if it's still visible.
+	if(pool.getNumPending() >= maxPendingTiles) return;
+	
+	Tile& tile = tiles[key];
+	tile.texture = NULL;
+	tile.loading = true;
+	tile.lastUsed = frame;
+	pool.push(new ofxClutterTileLoadJob(this, generation, key, tilePath(level, col, row)));
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTiledImage::showCoarserTile(int level, int col, int row) {
+	while(level > 0) {
+		level--;
+		col /= 2;
+		row /= 2;
+		map<gint64, Tile>::iterator it = tiles.find(tileKey(level, col, row));
+		if(it != tiles.end() && it->second.texture) {
+			it->second.lastUsed = frame;
+			return;
+		}
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTiledImage::tileLoaded(int generation, gint64 key, ofImage& img, bool success) {
+	if(generation != this->generation) return;
+	map<gint64, Tile>::iterator it = tiles.find(key);
+	if(it == tiles.end()) return;
+	
+	Tile& tile = it->second;
+	tile.loading = false;
+	if(!success) {
+		ofLog(OF_LOG_WARNING, "ofxClutterTiledImage: couldn't load " + tilePath(keyLevel(key), keyCol(key), keyRow(key)));
+		return;
+	}
+	
+	int bpp = img.bpp / 8;
+	GError *error=NULL;
+	ClutterActor* texture = clutter_texture_new();
+	if(!clutter_texture_set_from_rgb_data(CLUTTER_TEXTURE(texture), img.getPixels(), bpp==4,
+										  img.width, img.height, img.width*bpp, bpp,
+										  CLUTTER_TEXTURE_NONE, &error)) {
+		fprintf (stderr, "Unable to upload tile: %s\n", error->message);
+		g_error_free(error);
+		clutter_actor_destroy(texture);
+		return;
+	}
+	clutter_actor_set_position(texture, keyCol(key)*tileSize, keyRow(key)*tileSize);
+	clutter_container_add_actor(CLUTTER_CONTAINER(levelGroups[keyLevel(key)]), texture);
+	if(tile.lastUsed != frame) clutter_actor_hide(texture);
+	tile.texture = texture;
+}
+
+
+//------------------------------------------------------------
+// Drops the least recently needed tiles once there are too many
+void ofxClutterTiledImage::evictTiles() {
+	if(tiles.size() <= maxCachedTiles) return;
+	
+	vector< pair<int, gint64> > unused;
+	for(map<gint64, Tile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+		if(it->second.lastUsed != frame && !it->second.loading) {
+			unused.push_back(make_pair(it->second.lastUsed, it->first));
+		}
+	}
+	sort(unused.begin(), unused.end());
+	
+	for(int i=0; i<unused.size() && tiles.size() > maxCachedTiles; i++) {
+		Tile& tile = tiles[unused[i].second];
+		if(tile.texture) clutter_actor_destroy(tile.texture);
+		tiles.erase(unused[i].second);
+	}
+}
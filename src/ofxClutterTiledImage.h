@@ -0,0 +1,84 @@
+/*
+ *  ofxClutterTiledImage.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterWorkerPool.h"
+
+
+// Shows images far bigger than the maximum texture size by only loading
+// the tiles that are on screen, at the resolution they are drawn at.
+//
+// The image has to be turned into a tile pyramid first with buildPyramid()
+// (one slow, full decode).  Level 0 is the whole image in a single tile and
+// each level above doubles the resolution, up to the full size.  Tiles are
+// decoded on worker threads and uploaded from update(), a few per frame.
+// While a tile loads, the nearest coarser tile that's already loaded is
+// shown in its place, so zooming in sharpens progressively.
+//
+// The actor is as big as the full resolution image; move and scale it
+// (or its parents) to pan and zoom, and call update() every frame.
+class ofxClutterTiledImage : public ofxClutterActor {
+public:
+	ofxClutterTiledImage();
+	~ofxClutterTiledImage();
+	
+	// Decodes source and writes the pyramid into dir
+	static bool buildPyramid(string source, string dir, int tileSize=256);
+	
+	// Opens a pyramid written by buildPyramid()
+	bool load(string dir);
+	
+	void update();
+	
+	// Most tile textures kept around, on screen or not
+	void setMaxCachedTiles(int n) { maxCachedTiles = n; }
+	void setMaxUploadsPerFrame(int n) { maxUploadsPerFrame = n; }
+	
+	int getImageWidth() { return imageWidth; }
+	int getImageHeight() { return imageHeight; }
+	int getNumLevels() { return numLevels; }
+	int getCurrentLevel() { return currentLevel; }
+	int getNumCachedTiles() { return tiles.size(); }
+	int getNumPendingTiles() { return pool.getNumPending(); }
+	
+	// Called by the tile loading jobs
+	void tileLoaded(int generation, gint64 key, ofImage& img, bool success);
+	
+protected:
+	struct Tile {
+		ClutterActor* texture;		// NULL until loaded
+		bool loading;
+		int lastUsed;				// frame it was last needed
+	};
+	
+	gint64 tileKey(int level, int col, int row) { return ((gint64)level << 48) | ((gint64)col << 24) | row; }
+	int keyLevel(gint64 key) { return key >> 48; }
+	int keyCol(gint64 key) { return (key >> 24) & 0xFFFFFF; }
+	int keyRow(gint64 key) { return key & 0xFFFFFF; }
+	string tilePath(int level, int col, int row);
+	
+	void requestTile(int level, int col, int row);
+	void showCoarserTile(int level, int col, int row);
+	void evictTiles();
+	
+	string dir;
+	string extension;
+	int imageWidth, imageHeight;
+	int tileSize;
+	int numLevels;
+	int currentLevel;
+	int generation;				// bumped by load() so stale jobs are ignored
+	
+	int frame;
+	int maxCachedTiles;
+	int maxUploadsPerFrame;
+	int maxPendingTiles;
+	
+	map<gint64, Tile> tiles;
+	vector<ClutterActor*> levelGroups;
+	ofxClutterWorkerPool pool;
+};
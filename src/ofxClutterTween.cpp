@@ -0,0 +1,347 @@
+/*
+ *  ofxClutterTween.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterTween.h"
+
+// We need access to the stage
+extern "C" {
+#include "ofxAppClutterWindow.h"
+};
+
+vector<int> ofxClutterTween::targets;
+vector<unsigned char> ofxClutterTween::properties;
+vector<float> ofxClutterTween::from;
+vector<float> ofxClutterTween::to;
+vector<double> ofxClutterTween::start;
+vector<float> ofxClutterTween::duration;
+vector<int> ofxClutterTween::modes;
+vector<float> ofxClutterTween::progress;
+vector<float> ofxClutterTween::eased;
+vector<int> ofxClutterTween::order;
+bool ofxClutterTween::orderDirty = false;
+vector<ofxClutterTween::ActorState> ofxClutterTween::actors;
+map<ClutterActor*, int> ofxClutterTween::actorIndex;
+GTimer* ofxClutterTween::timer = NULL;
+guint ofxClutterTween::repaintFunc = 0;
+float ofxClutterTween::lastUpdateMillis = 0;
+
+
+//------------------------------------------------------------
+double ofxClutterTween::now() {
+	if(timer == NULL) timer = g_timer_new();
+	return g_timer_elapsed(timer, NULL) * 1000.0;
+}
+
+
+//------------------------------------------------------------
+float ofxClutterTween::getValue(ClutterActor* actor, ofxClutterTweenProperty property) {
+	gdouble sx, sy;
+	switch(property) {
+		case OFX_CLUTTER_TWEEN_X:			return clutter_actor_get_x(actor);
+		case OFX_CLUTTER_TWEEN_Y:			return clutter_actor_get_y(actor);
+		case OFX_CLUTTER_TWEEN_WIDTH:		return clutter_actor_get_width(actor);
+		case OFX_CLUTTER_TWEEN_HEIGHT:		return clutter_actor_get_height(actor);
+		case OFX_CLUTTER_TWEEN_DEPTH:		return clutter_actor_get_depth(actor);
+		case OFX_CLUTTER_TWEEN_SCALE_X:
+			clutter_actor_get_scale(actor, &sx, &sy);
+			return sx;
+		case OFX_CLUTTER_TWEEN_SCALE_Y:
+			clutter_actor_get_scale(actor, &sx, &sy);
+			return sy;
+		case OFX_CLUTTER_TWEEN_ROTATION_Z:	return clutter_actor_get_rotation(actor, CLUTTER_Z_AXIS, NULL, NULL, NULL);
+		case OFX_CLUTTER_TWEEN_OPACITY:		return clutter_actor_get_opacity(actor);
+		default: break;
+	}
+	return 0;
+}
+
+
+//------------------------------------------------------------
+// Values are read from the actor when a tween starts on them; the rest of
+// the actor is never written from this copy
+int ofxClutterTween::getActorState(ClutterActor* actor) {
+	map<ClutterActor*, int>::iterator it = actorIndex.find(actor);
+	if(it != actorIndex.end()) return it->second;
+	
+	ActorState s;
+	s.actor = actor;
+	g_object_ref(actor);
+	for(int i=0; i<OFX_CLUTTER_TWEEN_NUM_PROPERTIES; i++) {
+		s.values[i] = 0;
+		s.tweens[i] = -1;
+	}
+	s.numTweens = 0;
+	s.dirty = 0;
+	
+	actors.push_back(s);
+	actorIndex[actor] = actors.size() - 1;
+	return actors.size() - 1;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::add(ofxClutterActor* actor, ofxClutterTweenProperty property, float to,
+						  float durationMillis, int mode, float delayMillis) {
+	// A running tween's value is newer than the actor's, which is only
+	// written at the next repaint; otherwise the app may have moved it since
+	int a = getActorState(actor->actor);
+	if(actors[a].tweens[property] < 0) actors[a].values[property] = getValue(actor->actor, property);
+	add(actor, property, actors[a].values[property], to, durationMillis, mode, delayMillis);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::add(ofxClutterActor* actor, ofxClutterTweenProperty property, float from, float to,
+						  float durationMillis, int mode, float delayMillis) {
+	if(!ofxClutterEasing::isSupported(mode)) {
+		ofLog(OF_LOG_WARNING, "ofxClutterTween: unsupported easing mode, using CLUTTER_LINEAR");
+		mode = CLUTTER_LINEAR;
+	}
+	
+	int a = getActorState(actor->actor);
+	int i = actors[a].tweens[property];
+	if(i < 0) {
+		actors[a].values[property] = getValue(actor->actor, property);
+		i = targets.size();
+		targets.push_back(a);
+		properties.push_back(property);
+		ofxClutterTween::from.push_back(0);
+		ofxClutterTween::to.push_back(0);
+		start.push_back(0);
+		duration.push_back(0);
+		modes.push_back(0);
+		actors[a].tweens[property] = i;
+		actors[a].numTweens++;
+	}
+	ofxClutterTween::from[i] = from;
+	ofxClutterTween::to[i] = to;
+	start[i] = now() + delayMillis;
+	duration[i] = MAX(durationMillis, 1);
+	modes[i] = mode;
+	orderDirty = true;
+	
+	if(repaintFunc == 0) repaintFunc = clutter_threads_add_repaint_func(onRepaint, NULL, NULL);
+	clutter_actor_queue_redraw(stage);
+}
+
+
+//------------------------------------------------------------
+// Moves the last tween into slot i, and drops the actor's state with its
+// last tween
+void ofxClutterTween::removeTween(int i) {
+	int a = targets[i];
+	actors[a].tweens[properties[i]] = -1;
+	int last = targets.size() - 1;
+	if(i != last) {
+		targets[i] = targets[last];
+		properties[i] = properties[last];
+		from[i] = from[last];
+		to[i] = to[last];
+		start[i] = start[last];
+		duration[i] = duration[last];
+		modes[i] = modes[last];
+		actors[targets[i]].tweens[properties[i]] = i;
+	}
+	targets.pop_back();
+	properties.pop_back();
+	from.pop_back();
+	to.pop_back();
+	start.pop_back();
+	duration.pop_back();
+	modes.pop_back();
+	orderDirty = true;
+	
+	if(--actors[a].numTweens == 0) removeActorState(a);
+}
+
+
+//------------------------------------------------------------
+// Moves the last actor state into slot a; its tweens are pointed there
+void ofxClutterTween::removeActorState(int a) {
+	actorIndex.erase(actors[a].actor);
+	g_object_unref(actors[a].actor);
+	
+	int last = actors.size() - 1;
+	if(a != last) {
+		actors[a] = actors[last];
+		actorIndex[actors[a].actor] = a;
+		for(int p=0; p<OFX_CLUTTER_TWEEN_NUM_PROPERTIES; p++) {
+			if(actors[a].tweens[p] >= 0) targets[actors[a].tweens[p]] = a;
+		}
+	}
+	actors.pop_back();
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::set(ofxClutterActor* actor, ofxClutterTweenProperty property, float value) {
+	stop(actor, property);
+	
+	// Keep the engine's copy in step if the actor is still being animated
+	map<ClutterActor*, int>::iterator it = actorIndex.find(actor->actor);
+	if(it != actorIndex.end()) actors[it->second].values[property] = value;
+	
+	ClutterActor* a = actor->actor;
+	gdouble sx, sy;
+	switch(property) {
+		case OFX_CLUTTER_TWEEN_X:			clutter_actor_set_x(a, value); break;
+		case OFX_CLUTTER_TWEEN_Y:			clutter_actor_set_y(a, value); break;
+		case OFX_CLUTTER_TWEEN_WIDTH:		clutter_actor_set_width(a, value); break;
+		case OFX_CLUTTER_TWEEN_HEIGHT:		clutter_actor_set_height(a, value); break;
+		case OFX_CLUTTER_TWEEN_DEPTH:		clutter_actor_set_depth(a, value); break;
+		case OFX_CLUTTER_TWEEN_SCALE_X:
+			clutter_actor_get_scale(a, &sx, &sy);
+			clutter_actor_set_scale(a, value, sy);
+			break;
+		case OFX_CLUTTER_TWEEN_SCALE_Y:
+			clutter_actor_get_scale(a, &sx, &sy);
+			clutter_actor_set_scale(a, sx, value);
+			break;
+		case OFX_CLUTTER_TWEEN_ROTATION_Z:	clutter_actor_set_rotation(a, CLUTTER_Z_AXIS, value, 0, 0, 0); break;
+		case OFX_CLUTTER_TWEEN_OPACITY:		clutter_actor_set_opacity(a, CLAMP(value, 0, 255)); break;
+		default: break;
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::stop(ofxClutterActor* actor, ofxClutterTweenProperty property) {
+	map<ClutterActor*, int>::iterator it = actorIndex.find(actor->actor);
+	if(it == actorIndex.end()) return;
+	int i = actors[it->second].tweens[property];
+	if(i >= 0) removeTween(i);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::stop(ofxClutterActor* actor) {
+	for(int p=0; p<OFX_CLUTTER_TWEEN_NUM_PROPERTIES; p++) {
+		stop(actor, (ofxClutterTweenProperty)p);
+	}
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::stopAll() {
+	while(!targets.empty()) removeTween(targets.size() - 1);
+}
+
+
+//------------------------------------------------------------
+bool ofxClutterTween::isAnimating(ofxClutterActor* actor) {
+	map<ClutterActor*, int>::iterator it = actorIndex.find(actor->actor);
+	if(it == actorIndex.end()) return false;
+	for(int p=0; p<OFX_CLUTTER_TWEEN_NUM_PROPERTIES; p++) {
+		if(actors[it->second].tweens[p] >= 0) return true;
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterTween::update() {
+	double t = now();
+	int n = targets.size();
+	progress.resize(n);
+	eased.resize(n);
+	
+	// Progress for everything in one flat loop
+	for(int i=0; i<n; i++) {
+		progress[i] = (t - start[i]) / duration[i];
+	}
+	
+	// Ease each mode's run of tweens together; eased is in that order
+	if(orderDirty) {
+		vector<int> counts(CLUTTER_ANIMATION_LAST + 1, 0);
+		for(int i=0; i<n; i++) counts[modes[i] + 1]++;
+		for(int m=1; m<counts.size(); m++) counts[m] += counts[m-1];
+		order.resize(n);
+		for(int i=0; i<n; i++) order[counts[modes[i]]++] = i;
+		orderDirty = false;
+	}
+	for(int k=0; k<n; k++) eased[k] = CLAMP(progress[order[k]], 0, 1);
+	for(int k=0; k<n; ) {
+		int mode = modes[order[k]];
+		int end = k;
+		while(end < n && modes[order[end]] == mode) end++;
+		ofxClutterEasing::evaluate(mode, &eased[k], &eased[k], end - k);
+		k = end;
+	}
+	
+	// Write into the actor states; tweens still in their delay don't touch them
+	for(int k=0; k<n; k++) {
+		int i = order[k];
+		if(progress[i] < 0) continue;
+		ActorState& s = actors[targets[i]];
+		s.values[properties[i]] = from[i] + (to[i] - from[i]) * eased[k];
+		s.dirty |= 1 << properties[i];
+	}
+	
+	pushValues();
+	
+	for(int i=n-1; i>=0; i--) {
+		if(progress[i] >= 1) removeTween(i);
+	}
+	
+	lastUpdateMillis = now() - t;
+}
+
+
+//------------------------------------------------------------
+// One setter per changed pair of properties when both halves are being
+// tweened; otherwise only the tweened half is set, so whatever the app
+// did to the other one stays
+void ofxClutterTween::pushValues() {
+	const unsigned int x = 1 << OFX_CLUTTER_TWEEN_X, y = 1 << OFX_CLUTTER_TWEEN_Y;
+	const unsigned int w = 1 << OFX_CLUTTER_TWEEN_WIDTH, h = 1 << OFX_CLUTTER_TWEEN_HEIGHT;
+	const unsigned int sx = 1 << OFX_CLUTTER_TWEEN_SCALE_X, sy = 1 << OFX_CLUTTER_TWEEN_SCALE_Y;
+	
+	for(int i=0; i<actors.size(); i++) {
+		ActorState& s = actors[i];
+		if(!s.dirty) continue;
+		float* v = s.values;
+		unsigned int d = s.dirty;
+		
+		if((d & (x | y)) == (x | y)) clutter_actor_set_position(s.actor, v[OFX_CLUTTER_TWEEN_X], v[OFX_CLUTTER_TWEEN_Y]);
+		else if(d & x) clutter_actor_set_x(s.actor, v[OFX_CLUTTER_TWEEN_X]);
+		else if(d & y) clutter_actor_set_y(s.actor, v[OFX_CLUTTER_TWEEN_Y]);
+		
+		if((d & (w | h)) == (w | h)) clutter_actor_set_size(s.actor, v[OFX_CLUTTER_TWEEN_WIDTH], v[OFX_CLUTTER_TWEEN_HEIGHT]);
+		else if(d & w) clutter_actor_set_width(s.actor, v[OFX_CLUTTER_TWEEN_WIDTH]);
+		else if(d & h) clutter_actor_set_height(s.actor, v[OFX_CLUTTER_TWEEN_HEIGHT]);
+		
+		if(d & 1 << OFX_CLUTTER_TWEEN_DEPTH) {
+			clutter_actor_set_depth(s.actor, v[OFX_CLUTTER_TWEEN_DEPTH]);
+		}
+		if(d & (sx | sy)) {
+			gdouble scaleX, scaleY;
+			clutter_actor_get_scale(s.actor, &scaleX, &scaleY);
+			if(d & sx) scaleX = v[OFX_CLUTTER_TWEEN_SCALE_X];
+			if(d & sy) scaleY = v[OFX_CLUTTER_TWEEN_SCALE_Y];
+			clutter_actor_set_scale(s.actor, scaleX, scaleY);
+		}
+		if(d & 1 << OFX_CLUTTER_TWEEN_ROTATION_Z) {
+			gfloat cx, cy, cz;
+			clutter_actor_get_rotation(s.actor, CLUTTER_Z_AXIS, &cx, &cy, &cz);
+			clutter_actor_set_rotation(s.actor, CLUTTER_Z_AXIS, v[OFX_CLUTTER_TWEEN_ROTATION_Z], cx, cy, cz);
+		}
+		if(d & 1 << OFX_CLUTTER_TWEEN_OPACITY) {
+			clutter_actor_set_opacity(s.actor, CLAMP(v[OFX_CLUTTER_TWEEN_OPACITY], 0, 255));
+		}
+		s.dirty = 0;
+	}
+}
+
+
+//------------------------------------------------------------
+// Runs before every stage repaint and keeps the repaints coming while
+// anything is animating
+gboolean ofxClutterTween::onRepaint(gpointer data) {
+	if(targets.empty()) return TRUE;
+	update();
+	if(!targets.empty()) clutter_actor_queue_redraw(stage);
+	return TRUE;
+}
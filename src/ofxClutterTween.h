@@ -0,0 +1,93 @@
+/*
+ *  ofxClutterTween.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofxClutterActor.h"
+#include "ofxClutterEasing.h"
+
+enum ofxClutterTweenProperty {
+	OFX_CLUTTER_TWEEN_X,
+	OFX_CLUTTER_TWEEN_Y,
+	OFX_CLUTTER_TWEEN_WIDTH,
+	OFX_CLUTTER_TWEEN_HEIGHT,
+	OFX_CLUTTER_TWEEN_DEPTH,
+	OFX_CLUTTER_TWEEN_SCALE_X,
+	OFX_CLUTTER_TWEEN_SCALE_Y,
+	OFX_CLUTTER_TWEEN_ROTATION_Z,
+	OFX_CLUTTER_TWEEN_OPACITY,
+	OFX_CLUTTER_TWEEN_NUM_PROPERTIES
+};
+
+
+// Animates thousands of actor properties without a ClutterAnimation or
+// GValue per property.  Tweens live in flat arrays and are all evaluated
+// in one pass just before the stage repaints, grouped by easing mode; the
+// results are collected per actor and pushed with one setter call per
+// property pair (set_position, set_size, set_scale).
+//
+// A new tween on an actor property replaces the one already running on it.
+class ofxClutterTween {
+public:
+	// From the property's current value
+	static void add(ofxClutterActor* actor, ofxClutterTweenProperty property, float to,
+					float durationMillis, int mode=CLUTTER_LINEAR, float delayMillis=0);
+	static void add(ofxClutterActor* actor, ofxClutterTweenProperty property, float from, float to,
+					float durationMillis, int mode=CLUTTER_LINEAR, float delayMillis=0);
+	
+	// Stops any tween on the property and sets it right away
+	static void set(ofxClutterActor* actor, ofxClutterTweenProperty property, float value);
+	
+	static void stop(ofxClutterActor* actor, ofxClutterTweenProperty property);
+	static void stop(ofxClutterActor* actor);
+	static void stopAll();
+	
+	static bool isAnimating(ofxClutterActor* actor);
+	static int getNumActive() { return targets.size(); }
+	
+	// Evaluates every tween; called automatically before each repaint
+	static void update();
+	static float getLastUpdateMillis() { return lastUpdateMillis; }
+	
+protected:
+	// The current value of each tweened property; properties that aren't
+	// being tweened are read from the actor, never from here.  Kept, with a
+	// reference on the actor, only while the actor has tweens.
+	struct ActorState {
+		ClutterActor* actor;
+		float values[OFX_CLUTTER_TWEEN_NUM_PROPERTIES];
+		int tweens[OFX_CLUTTER_TWEEN_NUM_PROPERTIES];		// index of the running tween or -1
+		int numTweens;
+		unsigned int dirty;
+	};
+	
+	static int getActorState(ClutterActor* actor);
+	static void removeActorState(int a);
+	static float getValue(ClutterActor* actor, ofxClutterTweenProperty property);
+	static void removeTween(int i);
+	static void pushValues();
+	static double now();
+	static gboolean onRepaint(gpointer data);
+	
+	// One entry per tween
+	static vector<int> targets;			// index into actors
+	static vector<unsigned char> properties;
+	static vector<float> from, to;
+	static vector<double> start;		// ms on the engine clock
+	static vector<float> duration;
+	static vector<int> modes;
+	
+	static vector<float> progress;
+	static vector<int> order;			// tweens grouped by mode, rebuilt when tweens change
+	static vector<float> eased;			// in that order
+	static bool orderDirty;
+	
+	static vector<ActorState> actors;
+	static map<ClutterActor*, int> actorIndex;
+	
+	static GTimer* timer;
+	static guint repaintFunc;
+	static float lastUpdateMillis;
+};
@@ -0,0 +1,93 @@
+/*
+ *  ofxClutterWorkerPool.cpp
+ *  clutterExample
+ *
+ */
+
+#include "ofxClutterWorkerPool.h"
+#include <unistd.h>
+
+
+//------------------------------------------------------------
+ofxClutterWorkerPool::ofxClutterWorkerPool(int numThreads) {
+	if(numThreads <= 0) numThreads = getNumProcessors();
+	this->numThreads = numThreads;
+	numPushed = numFinished = 0;
+	cancelled = 0;
+	
+	finished = g_async_queue_new();
+	
+	GError *error=NULL;
+	pool = g_thread_pool_new(&ofxClutterWorkerPool::runJob, this, numThreads, FALSE, &error);
+	if(!pool) {
+		ofLog(OF_LOG_ERROR, "ofxClutterWorkerPool: couldn't start worker threads.");
+		fprintf (stderr, "Unable to create thread pool: %s\n", error->message);
+		g_error_free(error);
+	}
+}
+
+
+//------------------------------------------------------------
+ofxClutterWorkerPool::~ofxClutterWorkerPool() {
+	// Queued jobs still go through runJob(), but skip their work, so
+	// every job ends up in the finished queue and can be deleted here.
+	g_atomic_int_set(&cancelled, 1);
+	if(pool) g_thread_pool_free(pool, FALSE, TRUE);
+	
+	gpointer job;
+	while((job = g_async_queue_try_pop(finished))) {
+		delete (ofxClutterJob*)job;
+	}
+	g_async_queue_unref(finished);
+}
+
+
+//------------------------------------------------------------
+int ofxClutterWorkerPool::getNumProcessors() {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? n : 1;
+}
+
+
+//------------------------------------------------------------
+void ofxClutterWorkerPool::runJob(gpointer data, gpointer user_data) {
+	ofxClutterWorkerPool* self = (ofxClutterWorkerPool*)user_data;
+	ofxClutterJob* job = (ofxClutterJob*)data;
+	if(!g_atomic_int_get(&self->cancelled)) {
+		job->run();
+	}
+	g_async_queue_push(self->finished, job);
+}
+
+
+//------------------------------------------------------------
+void ofxClutterWorkerPool::push(ofxClutterJob* job) {
+	if(!pool) {
+		// No threads: do the work right here so callers still get results
+		job->run();
+		g_async_queue_push(finished, job);
+	}
+	else {
+		g_thread_pool_push(pool, job, NULL);
+	}
+	numPushed++;
+}
+
+
+//------------------------------------------------------------
+int ofxClutterWorkerPool::finishJobs(int maxJobs, int maxMillis) {
+	int start = ofGetElapsedTimeMillis();
+	int count = 0;
+	while(maxJobs < 0 || count < maxJobs) {
+		if(maxMillis >= 0 && count > 0 && ofGetElapsedTimeMillis() - start >= maxMillis) break;
+		
+		ofxClutterJob* job = (ofxClutterJob*)g_async_queue_try_pop(finished);
+		if(!job) break;
+		
+		job->finish();
+		delete job;
+		numFinished++;
+		count++;
+	}
+	return count;
+}
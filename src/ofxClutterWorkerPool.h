@@ -0,0 +1,55 @@
+/*
+ *  ofxClutterWorkerPool.h
+ *  clutterExample
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include <clutter/clutter.h>
+
+// A unit of background work.  run() is called on a worker thread and must
+// not touch Clutter, Cogl or OpenGL; finish() is called later on the main
+// thread from ofxClutterWorkerPool::finishJobs() and is where results get
+// uploaded or attached to actors.  The pool deletes the job after finish().
+class ofxClutterJob {
+public:
+	virtual ~ofxClutterJob() {}
+	virtual void run() = 0;
+	virtual void finish() {}
+};
+
+
+// Thin wrapper around a GThreadPool.  Jobs are handed back to the main
+// thread through a queue instead of idle callbacks, so the caller decides
+// how much finishing work to do per frame.
+class ofxClutterWorkerPool {
+public:
+	// 0 threads means one per processor
+	ofxClutterWorkerPool(int numThreads=0);
+	~ofxClutterWorkerPool();
+	
+	// Takes ownership of the job
+	void push(ofxClutterJob* job);
+	
+	// Call from the main thread, typically in update().  Finishes completed
+	// jobs until maxJobs have been done or maxMillis have passed (-1 = no limit)
+	// and returns how many were finished.  At least one job is finished per
+	// call if any are ready, so a tight budget still makes progress.
+	int finishJobs(int maxJobs=-1, int maxMillis=-1);
+	
+	int getNumThreads() { return numThreads; }
+	int getNumPending() { return numPushed - numFinished; }
+	
+	static int getNumProcessors();
+	
+protected:
+	static void runJob(gpointer data, gpointer user_data);
+	
+	GThreadPool* pool;
+	GAsyncQueue* finished;
+	volatile gint cancelled;
+	int numThreads;
+	int numPushed;
+	int numFinished;
+};